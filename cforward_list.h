@@ -7,24 +7,42 @@
 #include <iostream>
 #include <initializer_list>
 #include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+#include <dLink.h>
+#include "check.h"
 
 template<typename Elem>
-struct Link {
+struct Link : sLink_base<Link<Elem>> {
     Link(const Elem& v, Link* s = nullptr)
-        : val{ v }, succ{ s } { }
+        : sLink_base<Link>{ s }, val{ v } { }
+
+    template<typename... Args>
+    explicit Link(std::in_place_t, Args&&... args)   // build val in place from args
+        : sLink_base<Link>{ nullptr }, val(std::forward<Args>(args)...) { }
 
-    Link* succ;     // successor (next) node
     Elem val;       // the value
 };
 
-template<typename Elem>
+// A is rebound to the node type, so any allocator of Elem works, including
+// std::pmr ones (see pmr::cforward_list below)
+template<typename Elem, typename A = std::allocator<Elem>>
 class cforward_list {
 public:
-    cforward_list()
-        : sz{ 0 }, first{ alloc.allocate(1) }, last{ alloc.allocate(1) }
+    using allocator_type = A;
+    using node_allocator = typename std::allocator_traits<A>::template rebind_alloc<Link<Elem>>;
+    using node_traits = std::allocator_traits<node_allocator>;
+    using link = sLink_base<Link<Elem>>;   // what the ring is made of; the sentinels are bare links
+
+    cforward_list() noexcept(std::is_nothrow_default_constructible<node_allocator>::value)
+    {
+    }
+
+    explicit cforward_list(const A& a) noexcept(std::is_nothrow_constructible<node_allocator, const A&>::value)
+        : alloc(a)
     {
-        first->succ = last;
-        last->succ = first;
     }
 
     cforward_list(std::initializer_list<Elem> lst)
@@ -38,11 +56,34 @@ public:
         sz = lst.size();
     }
 
+    cforward_list(cforward_list&& fl) noexcept
+        : alloc(fl.alloc)   // share fl's allocator: the nodes we steal came from it
+    {
+        steal(fl);
+    }
+
+    cforward_list& operator=(cforward_list&& fl) noexcept(node_traits::propagate_on_container_move_assignment::value
+        || node_traits::is_always_equal::value)
+    {
+        if (this == &fl) return *this;  // assignment to self
+
+        clear();
+        // nodes stay with their allocator, as in forward_list
+        if constexpr (node_traits::propagate_on_container_move_assignment::value)
+            std::swap(alloc, fl.alloc);
+        else if (alloc != fl.alloc) {
+            for (auto p = fl.first->succ; p != fl.last; p = p->succ)
+                emplace_back(std::move(p->node()->val));
+            fl.clear();
+            return *this;
+        }
+        steal(fl);
+        return *this;
+    }
+
     ~cforward_list()
     {
         clear();
-        alloc.deallocate(first, 1);
-        alloc.deallocate(last, 1);	// deallocate last
     }
 
     class iterator;
@@ -55,12 +96,21 @@ public:
     const iterator end() const { return iterator(last, first, last); }
 
     iterator insert_after(iterator p, const Elem& v); // insert v into cforward_list after p
+    iterator insert_after(iterator p, Elem&& v);
+    template<typename... Args>
+    iterator emplace_after(iterator p, Args&&... args); // construct a new elem after p from args
     iterator insert_before(iterator p, const Elem& v); // insert v into cforward_list before p
     iterator erase_after(iterator p);  // remove elem after p from the cforward_list
     iterator erase(iterator p);  // remove p from the cforward_list
 
     void push_back(const Elem& v);
     void push_front(const Elem& v);
+    void push_back(Elem&& v);
+    void push_front(Elem&& v);
+    template<typename... Args>
+    Elem& emplace_back(Args&&... args);
+    template<typename... Args>
+    Elem& emplace_front(Args&&... args);
     void pop_front();
     void pop_back();
 
@@ -74,16 +124,27 @@ public:
     int size() const { return sz; }
 
 private:
-    size_t sz;
-    Link<Elem>* first;
-    Link<Elem>* last;
-    std::allocator<Link<Elem>> alloc;
+    void steal(cforward_list& fl) noexcept; // take fl's nodes; *this must be empty
+
+    node_allocator alloc;
+    size_t sz = 0;
+    // an empty ring: first and last connected to each other
+    link first_base{ &last_base };    // storage of first
+    link last_base{ &first_base };    // storage of last
+    link* first{ &first_base };
+    link* last{ &last_base };
+    link* tail{ first };   // elem before last (first when empty), for O(1) push_back and back
 };
 
-template<typename Elem> // requires Element<Elem>() (§19.3.3)
-class cforward_list<Elem>::iterator {
+namespace pmr {
+    template<typename Elem>
+    using cforward_list = ::cforward_list<Elem, std::pmr::polymorphic_allocator<Elem>>;
+}
+
+template<typename Elem, typename A> // requires Element<Elem>() (§19.3.3)
+class cforward_list<Elem, A>::iterator {
 public:
-    iterator(Link<Elem>* p, Link<Elem>* first, Link<Elem>* last)
+    iterator(link* p, link* first, link* last)
         : curr{ p }, first{ first }, last{ last } { }
 
     // only overloaded for prefix increment
@@ -98,174 +159,233 @@ public:
     }
     Elem& operator*() // get value (dereference)
     {
-        if (curr == first || curr == last) // first and last are not to be accessed
-            throw std::out_of_range("dereference beyond range");
-        return curr->val;
+        HOMEMADE_CHECK(curr != first && curr != last, // first and last are not to be accessed
+            throw std::out_of_range("dereference beyond range"));
+        return curr->node()->val;
     }
     const Elem& operator*() const // get value (dereference)
     {
-        if (curr == first || curr == last) // first and last are not to be accessed
-            throw std::out_of_range("dereference beyond range");
-        return curr->val;
+        HOMEMADE_CHECK(curr != first && curr != last, // first and last are not to be accessed
+            throw std::out_of_range("dereference beyond range"));
+        return curr->node()->val;
     }
-    Link<Elem>* operator->() { return curr; }
+    Link<Elem>* operator->() { return curr->node(); }  // only for an element, not first or last
 
     bool operator==(const iterator& b) const { return curr == b.curr; }
     bool operator!=(const iterator& b) const { return curr != b.curr; }
     explicit operator bool() const { return curr; }
 
-    Link<Elem>* ptr() const { return curr; }
+    link* ptr() const { return curr; }
 
 private:
-    Link<Elem>* curr; // current link
+    link* curr; // current link
     // storing first last to impose iterator check
-    Link<Elem>* first;
-    Link<Elem>* last;
+    link* first;
+    link* last;
 };
 
 // may throw access violation exception
-template<typename Elem>
-typename cforward_list<Elem>::iterator cforward_list<Elem>::insert_after(
-    cforward_list<Elem>::iterator p, const Elem& v)
+template<typename Elem, typename A>
+typename cforward_list<Elem, A>::iterator cforward_list<Elem, A>::insert_after(
+    cforward_list<Elem, A>::iterator p, const Elem& v)
+{
+    return emplace_after(p, v);
+}
+
+template<typename Elem, typename A>
+typename cforward_list<Elem, A>::iterator cforward_list<Elem, A>::insert_after(
+    cforward_list<Elem, A>::iterator p, Elem&& v)
+{
+    return emplace_after(p, std::move(v));
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+typename cforward_list<Elem, A>::iterator cforward_list<Elem, A>::emplace_after(
+    cforward_list<Elem, A>::iterator p, Args&&... args)
 {
     if (p == end()) throw std::out_of_range("inserting after end()");
 
-    std::unique_ptr<Link<Elem>> newLink{ alloc.allocate(1) };// allocate
-    alloc.construct(newLink.get(), Link<Elem>(v));			// construct
+    Link<Elem>* newLink = node_traits::allocate(alloc, 1);   // allocate
+    try {
+        node_traits::construct(alloc, newLink, std::in_place, std::forward<Args>(args)...);  // construct
+    }
+    catch (...) {
+        node_traits::deallocate(alloc, newLink, 1);
+        throw;
+    }
 
-    newLink->succ = p->succ;
-    p->succ = newLink.get();
+    newLink->succ = p.ptr()->succ;
+    p.ptr()->succ = newLink;
+    if (p.ptr() == tail) tail = newLink;
 
     ++sz;
 
-    return iterator(newLink.release(), first, last);
+    return iterator(newLink, first, last);
 }
 
-template<typename Elem>
-typename cforward_list<Elem>::iterator cforward_list<Elem>::insert_before(
-    cforward_list<Elem>::iterator p, const Elem& v)
+template<typename Elem, typename A>
+typename cforward_list<Elem, A>::iterator cforward_list<Elem, A>::insert_before(
+    cforward_list<Elem, A>::iterator p, const Elem& v)
 {
     if (p == before_begin()) throw std::out_of_range("inserting beyond before_begin()");
 
     auto it = before_begin();
-    for (; it->succ != p.ptr(); ++it);  // iterate to elem before p
+    for (; it.ptr()->succ != p.ptr(); ++it);  // iterate to elem before p
     return insert_after(it, v);
 }
 
 // may throw access violation exception
 // invalidates erased element's iterator
-template<typename Elem>
-typename cforward_list<Elem>::iterator cforward_list<Elem>::erase_after(
-    cforward_list<Elem>::iterator p)
+template<typename Elem, typename A>
+typename cforward_list<Elem, A>::iterator cforward_list<Elem, A>::erase_after(
+    cforward_list<Elem, A>::iterator p)
 {
     if (sz == 0) throw std::runtime_error("empty list");
     if (p == end()) throw std::out_of_range("attempting to erase after end()");
-    if (p->succ == last) p = before_begin();
+    if (p.ptr()->succ == last) p = before_begin();
 
-    auto temp = p->succ;    // store iterator to be erased
-    p->succ = p->succ->succ;
+    link* temp = p.ptr()->succ;    // store link to be erased
+    p.ptr()->succ = temp->succ;
+    if (temp == tail) tail = p.ptr();
 
-    alloc.destroy(temp);
-    alloc.deallocate(temp, 1);
+    node_traits::destroy(alloc, temp->node());
+    node_traits::deallocate(alloc, temp->node(), 1);
 
     --sz;
 
-    return iterator(p->succ, first, last);
+    return iterator(p.ptr()->succ, first, last);
 }
 
 // don't use before_begin as p
 // invalidates erased element's iterator
-template<typename Elem>
-typename cforward_list<Elem>::iterator cforward_list<Elem>::erase(
-    cforward_list<Elem>::iterator p)
+template<typename Elem, typename A>
+typename cforward_list<Elem, A>::iterator cforward_list<Elem, A>::erase(
+    cforward_list<Elem, A>::iterator p)
 {
     if (sz == 0) throw std::runtime_error("empty list");
     if (p == before_begin()) throw std::runtime_error("attempting to erase before_begin()");
     if (p == end()) throw std::runtime_error("attempting to erase end()");
 
     auto it = before_begin();
-    for (; it->succ != p.ptr(); ++it);  // iterate to elem before p
+    for (; it.ptr()->succ != p.ptr(); ++it);  // iterate to elem before p
     return erase_after(it);
 }
 
-template<typename Elem>
-void cforward_list<Elem>::push_front(const Elem& v)
+template<typename Elem, typename A>
+void cforward_list<Elem, A>::push_front(const Elem& v)
 {
     insert_after(before_begin(), v);
 }
 
-template<typename Elem>
-void cforward_list<Elem>::push_back(const Elem& v)
+template<typename Elem, typename A>
+void cforward_list<Elem, A>::push_back(const Elem& v)
 {
-    auto it = before_begin();
-    for (; it->succ != last; ++it);  // iterate to elem before last
-    insert_after(it, v);
+    emplace_back(v);
 }
 
-template<typename Elem>
-void cforward_list<Elem>::pop_front()
+template<typename Elem, typename A>
+void cforward_list<Elem, A>::push_front(Elem&& v)
+{
+    insert_after(before_begin(), std::move(v));
+}
+
+template<typename Elem, typename A>
+void cforward_list<Elem, A>::push_back(Elem&& v)
+{
+    emplace_back(std::move(v));
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+Elem& cforward_list<Elem, A>::emplace_front(Args&&... args)
+{
+    return *emplace_after(before_begin(), std::forward<Args>(args)...);
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+Elem& cforward_list<Elem, A>::emplace_back(Args&&... args)
+{
+    return *emplace_after(iterator(tail, first, last), std::forward<Args>(args)...);
+}
+
+template<typename Elem, typename A>
+void cforward_list<Elem, A>::pop_front()
 {
     erase_after(before_begin());
 }
 
-template<typename Elem>
-void cforward_list<Elem>::pop_back()
+template<typename Elem, typename A>
+void cforward_list<Elem, A>::pop_back()
 {
     if (sz == 0) throw std::runtime_error("empty list");
 
     auto it = before_begin();
-    for (; it->succ->succ != last; ++it);  // iterate to 2 elems before last
+    for (; it.ptr()->succ->succ != last; ++it);  // iterate to 2 elems before last
     erase_after(it);
 }
 
-template<typename Elem>
-Elem& cforward_list<Elem>::front()
+template<typename Elem, typename A>
+Elem& cforward_list<Elem, A>::front()
 {
     if (sz == 0) throw std::runtime_error("empty cforward_list");
     return begin()->val;
 }
 
-template<typename Elem>
-const Elem& cforward_list<Elem>::front() const
+template<typename Elem, typename A>
+const Elem& cforward_list<Elem, A>::front() const
 {
     if (sz == 0) throw std::runtime_error("empty cforward_list");
     return begin()->val;
 }
 
-template<typename Elem>
-Elem& cforward_list<Elem>::back()
+template<typename Elem, typename A>
+Elem& cforward_list<Elem, A>::back()
 {
     if (sz == 0) throw std::runtime_error("empty cforward_list");
-    auto it = begin();
-    for (; it->succ != last; ++it);  // iterate to elem before last
-
-    return it->val;
+    return tail->node()->val;
 }
 
-template<typename Elem>
-const Elem& cforward_list<Elem>::back() const
+template<typename Elem, typename A>
+const Elem& cforward_list<Elem, A>::back() const
 {
     if (sz == 0) throw std::runtime_error("empty cforward_list");
-    auto it = begin();
-    for (; it->succ != last; ++it);  // iterate to elem before last
-
-    return it->val;
+    return tail->node()->val;
 }
 
-template<typename Elem>
-void cforward_list<Elem>::clear()
+template<typename Elem, typename A>
+void cforward_list<Elem, A>::clear()
 {
-    Link<Elem>* temp = nullptr; // storing p->succ, because after deleted, p->succ causes segfault
-    for (Link<Elem>* p = begin().ptr(); p != last; p = temp) {
+    link* temp = nullptr; // storing p->succ, because after deleted, p->succ causes segfault
+    for (link* p = first->succ; p != last; p = temp) {
         temp = p->succ;
-        alloc.destroy(p);
-        alloc.deallocate(p, 1);
+        node_traits::destroy(alloc, p->node());
+        node_traits::deallocate(alloc, p->node(), 1);
     }
 
     first->succ = last;
+    tail = first;
     sz = 0;
 }
 
+template<typename Elem, typename A>
+void cforward_list<Elem, A>::steal(cforward_list<Elem, A>& fl) noexcept
+{
+    if (fl.sz == 0) return;
+
+    // take the chain between fl's sentinels and hang it between ours
+    sz = fl.sz;
+    first->succ = fl.first->succ;
+    tail = fl.tail;
+    tail->succ = last;
+
+    // set fl's first to connect to its last
+    fl.first->succ = fl.last;
+    fl.tail = fl.first;
+    fl.sz = 0;
+}
+
 //=========================================================================================
 
 template<typename Iterator> // requires Forward_iterator<Iterator>
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cassert>
+#include <stdexcept>
+
+/**
+ * Level pemeriksaan untuk iterator dan at(), dipilih saat compile:
+ *
+ *   -DHOMEMADE_CHECK_LEVEL=0   no checks; list/forward_list iterators are a single pointer
+ *   -DHOMEMADE_CHECK_LEVEL=1   assert(), compiled out together with NDEBUG
+ *   -DHOMEMADE_CHECK_LEVEL=2   throw on misuse (default)
+ *
+ * All translation units of a program must use the same level.
+ */
+
+#ifndef HOMEMADE_CHECK_LEVEL
+#define HOMEMADE_CHECK_LEVEL 2
+#endif
+
+// HOMEMADE_CHECK(cond, fail): at level 2, evaluate fail (usually a throw)
+// when cond is false; fail is only ever evaluated on the failure path
+#if HOMEMADE_CHECK_LEVEL >= 2
+#define HOMEMADE_CHECK(cond, fail) do { if (!(cond)) fail; } while (false)
+#elif HOMEMADE_CHECK_LEVEL == 1
+#define HOMEMADE_CHECK(cond, fail) assert(cond)
+#else
+#define HOMEMADE_CHECK(cond, fail) ((void)0)
+#endif
@@ -1,29 +1,44 @@
 #include <iostream>
 #include <initializer_list>
 #include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+#include <dLink.h>
+#include "check.h"
 
 // JANGAN PAKAI RANGED-BASED FOR LOOP
 
 template<typename Elem>
-struct Link {
+struct Link : dLink_base<Link<Elem>> {
     Link(const Elem& v, Link* p = nullptr, Link* s = nullptr)
-        : val{ v }, prev{ p }, succ{ s } { }
+        : dLink_base<Link>{ p, s }, val{ v } { }
+
+    template<typename... Args>
+    explicit Link(std::in_place_t, Args&&... args)   // build val in place from args
+        : dLink_base<Link>{ nullptr, nullptr }, val(std::forward<Args>(args)...) { }
 
-    Link* prev;     // previous node
-    Link* succ;     // successor (next) node
     Elem val;       // the value
 };
 
-template<typename Elem>
+// A is rebound to the node type, so any allocator of Elem works, including
+// std::pmr ones (see pmr::CirList below)
+template<typename Elem, typename A = std::allocator<Elem>>
 class CirList {
 public:
-    CirList()
-        : sz{ 0 }, first{ alloc.allocate(1) }, last{ alloc.allocate(1) }
+    using allocator_type = A;
+    using node_allocator = typename std::allocator_traits<A>::template rebind_alloc<Link<Elem>>;
+    using node_traits = std::allocator_traits<node_allocator>;
+    using link = dLink_base<Link<Elem>>;   // what the ring is made of; the sentinels are bare links
+
+    CirList() noexcept(std::is_nothrow_default_constructible<node_allocator>::value)
+    {
+    }
+
+    explicit CirList(const A& a) noexcept(std::is_nothrow_constructible<node_allocator, const A&>::value)
+        : alloc(a)
     {
-        first->succ = last;
-        first->prev = last;
-        last->prev = first;
-        last->succ = first;
     }
 
     CirList(std::initializer_list<Elem> lst)
@@ -33,11 +48,59 @@ public:
             push_back(x);
     }
 
+    CirList(const CirList& l)
+        : alloc(node_traits::select_on_container_copy_construction(l.alloc))
+    {
+        // walk the links: an iterator would wrap around the ring forever
+        try {
+            for (auto p = l.first->succ; p != l.last; p = p->succ)
+                push_back(p->node()->val);
+        }
+        catch (...) {
+            clear();    // not delegating, so the destructor won't run
+            throw;
+        }
+    }
+
+    CirList(CirList&& l) noexcept
+        : alloc(l.alloc)    // share l's allocator: the nodes we steal came from it
+    {
+        steal(l);
+    }
+
+    CirList& operator=(const CirList& l)
+    {
+        if (this == &l) return *this;  // assignment to self
+
+        clear();
+        for (auto p = l.first->succ; p != l.last; p = p->succ)
+            push_back(p->node()->val);
+
+        return *this;
+    }
+
+    CirList& operator=(CirList&& l) noexcept(node_traits::propagate_on_container_move_assignment::value
+        || node_traits::is_always_equal::value)
+    {
+        if (this == &l) return *this;  // assignment to self
+
+        clear();
+        // nodes stay with their allocator, as in list
+        if constexpr (node_traits::propagate_on_container_move_assignment::value)
+            std::swap(alloc, l.alloc);
+        else if (alloc != l.alloc) {
+            for (auto p = l.first->succ; p != l.last; p = p->succ)
+                emplace_back(std::move(p->node()->val));
+            l.clear();
+            return *this;
+        }
+        steal(l);
+        return *this;
+    }
+
     ~CirList()
     {
         clear();
-        alloc.deallocate(first, 1); // deallocate first
-        alloc.deallocate(last, 1);	// deallocate last
     }
 
     class iterator; // member type: iterator
@@ -48,10 +111,19 @@ public:
     const iterator end() const { return iterator(last, first, last); }
 
     iterator insert(iterator p, const Elem& v); // insert v into CirList before p
+    iterator insert(iterator p, Elem&& v);
+    template<typename... Args>
+    iterator emplace(iterator p, Args&&... args); // construct a new elem before p from args
     iterator erase(iterator p); // remove p from the CirList
 
     void push_back(const Elem& v); // insert v at end
     void push_front(const Elem& v); // insert v at front
+    void push_back(Elem&& v);
+    void push_front(Elem&& v);
+    template<typename... Args>
+    Elem& emplace_back(Args&&... args);
+    template<typename... Args>
+    Elem& emplace_front(Args&&... args);
     void pop_front(); // remove the first element
     void pop_back(); // remove the last element
 
@@ -65,16 +137,26 @@ public:
     int size() const { return sz; }
 
 private:
-    size_t sz;
-    Link<Elem>* first;	// one elem before range
-    Link<Elem>* last;	// one elem beyond range
-    std::allocator<Link<Elem>> alloc;
+    void steal(CirList& l) noexcept; // take l's nodes; *this must be empty
+
+    node_allocator alloc;
+    size_t sz = 0;
+    // an empty ring: first and last connected to each other both ways
+    link first_base{ &last_base, &last_base };  // storage of first
+    link last_base{ &first_base, &first_base };  // storage of last
+    link* first{ &first_base };	// one elem before range
+    link* last{ &last_base };	// one elem beyond range
 };
 
-template<typename Elem> // requires Element<Elem>() (§19.3.3)
-class CirList<Elem>::iterator {
+namespace pmr {
+    template<typename Elem>
+    using CirList = ::CirList<Elem, std::pmr::polymorphic_allocator<Elem>>;
+}
+
+template<typename Elem, typename A> // requires Element<Elem>() (§19.3.3)
+class CirList<Elem, A>::iterator {
 public:
-    iterator(Link<Elem>* p, Link<Elem>* first, Link<Elem>* last)
+    iterator(link* p, link* first, link* last)
         : curr{ p }, first{ first }, last{ last } { }
 
     // only overloaded for prefix decrement and increment
@@ -98,53 +180,74 @@ public:
     }
     Elem& operator*() // get value (dereference)
     {
-        if (curr == first || curr == last)  // first and last are not to be accessed
-            throw std::out_of_range("dereference beyond range");
-        return curr->val;
+        HOMEMADE_CHECK(curr != first && curr != last,  // first and last are not to be accessed
+            throw std::out_of_range("dereference beyond range"));
+        return curr->node()->val;
     }
     const Elem& operator*() const // get value (dereference)
     {
-        if (curr == first || curr == last)  // first and last are not to be accessed
-            throw std::out_of_range("dereference beyond range");
-        return curr->val;
+        HOMEMADE_CHECK(curr != first && curr != last,  // first and last are not to be accessed
+            throw std::out_of_range("dereference beyond range"));
+        return curr->node()->val;
     }
 
-    Link<Elem>* operator->() { return curr; }
+    Link<Elem>* operator->() { return curr->node(); }  // only for an element, not first or last
 
     bool operator==(const iterator& b) const { return curr == b.curr; }
     bool operator!=(const iterator& b) const { return curr != b.curr; }
     explicit operator bool() const { return curr; }
 
-    Link<Elem>* ptr() const { return curr; }
+    link* ptr() const { return curr; }
 
 private:
-    Link<Elem>* curr; // current link
+    link* curr; // current link
     // storing first last to impose iterator check
-    Link<Elem>* first;
-    Link<Elem>* last;
+    link* first;
+    link* last;
 };
 
-template<typename Elem>
-typename CirList<Elem>::iterator CirList<Elem>::insert(CirList<Elem>::iterator p,
+template<typename Elem, typename A>
+typename CirList<Elem, A>::iterator CirList<Elem, A>::insert(CirList<Elem, A>::iterator p,
     const Elem& v)
+{
+    return emplace(p, v);
+}
+
+template<typename Elem, typename A>
+typename CirList<Elem, A>::iterator CirList<Elem, A>::insert(CirList<Elem, A>::iterator p,
+    Elem&& v)
+{
+    return emplace(p, std::move(v));
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+typename CirList<Elem, A>::iterator CirList<Elem, A>::emplace(CirList<Elem, A>::iterator p,
+    Args&&... args)
 {
     if (p.ptr() == first) throw std::out_of_range("attempting to insert before first");
 
-    std::unique_ptr<Link<Elem>> newLink{ alloc.allocate(1) };// allocate
-    alloc.construct(newLink.get(), Link<Elem>(v));			// construct
+    Link<Elem>* newLink = node_traits::allocate(alloc, 1);   // allocate
+    try {
+        node_traits::construct(alloc, newLink, std::in_place, std::forward<Args>(args)...);  // construct
+    }
+    catch (...) {
+        node_traits::deallocate(alloc, newLink, 1);
+        throw;
+    }
 
     newLink->succ = p.ptr();
-    newLink->prev = p->prev;
-    p->prev->succ = newLink.get();
-    p->prev = newLink.get();
+    newLink->prev = p.ptr()->prev;
+    p.ptr()->prev->succ = newLink;
+    p.ptr()->prev = newLink;
 
     ++sz;
 
-    return iterator(newLink.release(), first, last);
+    return iterator(newLink, first, last);
 }
 
-template<typename Elem>
-typename CirList<Elem>::iterator CirList<Elem>::erase(CirList<Elem>::iterator p)
+template<typename Elem, typename A>
+typename CirList<Elem, A>::iterator CirList<Elem, A>::erase(CirList<Elem, A>::iterator p)
 {
     if (sz == 0) throw std::runtime_error("empty CirList");   // empty CirList
     // trying to erase end()
@@ -152,79 +255,106 @@ typename CirList<Elem>::iterator CirList<Elem>::erase(CirList<Elem>::iterator p)
     // trying to erase first
     if (p.ptr() == first) throw std::out_of_range("attempting to erase before begin()");
 
-    p->succ->prev = p->prev;
-    p->prev->succ = p->succ;
+    Link<Elem>* n = p.ptr()->node();    // p is an element here, not a sentinel
+    n->succ->prev = n->prev;
+    n->prev->succ = n->succ;
 
-    auto it = p->succ;		// iterator to be returned
+    auto it = n->succ;		// iterator to be returned
 
-    alloc.destroy(p.ptr());
-    alloc.deallocate(p.ptr(), 1);
+    node_traits::destroy(alloc, n);
+    node_traits::deallocate(alloc, n, 1);
     --sz;
 
     return iterator(it, first, last);   // return value after p prior to removal
 }
 
-template<typename Elem>
-void CirList<Elem>::push_back(const Elem& v)
+template<typename Elem, typename A>
+void CirList<Elem, A>::push_back(const Elem& v)
 {
     insert(end(), v);
 }
 
-template<typename Elem>
-void CirList<Elem>::push_front(const Elem& v)
+template<typename Elem, typename A>
+void CirList<Elem, A>::push_front(const Elem& v)
 {
     insert(begin(), v);
 }
 
-template<typename Elem>
-void CirList<Elem>::pop_back()
+template<typename Elem, typename A>
+void CirList<Elem, A>::push_back(Elem&& v)
+{
+    insert(end(), std::move(v));
+}
+
+template<typename Elem, typename A>
+void CirList<Elem, A>::push_front(Elem&& v)
+{
+    insert(begin(), std::move(v));
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+Elem& CirList<Elem, A>::emplace_back(Args&&... args)
+{
+    return *emplace(end(), std::forward<Args>(args)...);
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+Elem& CirList<Elem, A>::emplace_front(Args&&... args)
+{
+    return *emplace(begin(), std::forward<Args>(args)...);
+}
+
+template<typename Elem, typename A>
+void CirList<Elem, A>::pop_back()
 {
     iterator p{ last->prev, first, last };
     erase(p);
 }
 
-template<typename Elem>
-void CirList<Elem>::pop_front()
+template<typename Elem, typename A>
+void CirList<Elem, A>::pop_front()
 {
     erase(begin());
 }
 
-template<typename Elem>
-Elem& CirList<Elem>::front()
+template<typename Elem, typename A>
+Elem& CirList<Elem, A>::front()
 {
     if (sz == 0) throw std::runtime_error("empty CirList");
     return begin()->val;
 }
 
-template<typename Elem>
-Elem& CirList<Elem>::back()
+template<typename Elem, typename A>
+Elem& CirList<Elem, A>::back()
 {
     if (sz == 0) throw std::runtime_error("empty CirList");
-    return end()->prev->val;
+    return last->prev->node()->val;
 }
 
-template<typename Elem>
-const Elem& CirList<Elem>::front() const
+template<typename Elem, typename A>
+const Elem& CirList<Elem, A>::front() const
 {
     if (sz == 0) throw std::runtime_error("empty CirList");
     return begin()->val;
 }
 
-template<typename Elem>
-const Elem& CirList<Elem>::back() const
+template<typename Elem, typename A>
+const Elem& CirList<Elem, A>::back() const
 {
     if (sz == 0) throw std::runtime_error("empty CirList");
-    return end()->prev->val;
+    return last->prev->node()->val;
 }
 
-template<typename Elem>
-void CirList<Elem>::clear()
+template<typename Elem, typename A>
+void CirList<Elem, A>::clear()
 {
-    Link<Elem>* temp = nullptr; // storing p->succ, because after deleted, p->succ causes segfault
-    for (Link<Elem>* p = begin().ptr(); p != last; p = temp) {
+    link* temp = nullptr; // storing p->succ, because after deleted, p->succ causes segfault
+    for (link* p = first->succ; p != last; p = temp) {
         temp = p->succ;
-        alloc.destroy(p);
-        alloc.deallocate(p, 1);
+        node_traits::destroy(alloc, p->node());
+        node_traits::deallocate(alloc, p->node(), 1);
     }
 
     // link first and last
@@ -233,6 +363,24 @@ void CirList<Elem>::clear()
     sz = 0;
 }
 
+template<typename Elem, typename A>
+void CirList<Elem, A>::steal(CirList<Elem, A>& l) noexcept
+{
+    if (l.sz == 0) return;
+
+    // take the chain between l's sentinels and hang it between ours
+    sz = l.sz;
+    first->succ = l.first->succ;
+    first->succ->prev = first;
+    last->prev = l.last->prev;
+    last->prev->succ = last;
+
+    // set l's first and last to connect to each other
+    l.first->succ = l.last;
+    l.last->prev = l.first;
+    l.sz = 0;
+}
+
 //==============================================================================
 
 template<typename Iterator> // requires Bidirectional_iterator<Iterator>
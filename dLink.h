@@ -1,12 +1,89 @@
 #pragma once
 
+#include <cstddef>
+#include <utility>
+
+// The links of a doubly linked node without the value. A list embeds its
+// sentinels as link bases, so an empty list owns no node at all. Chains are
+// made of link bases; node() gets the whole node back and must only be
+// called on a real node, never on a sentinel.
+template<typename Node>
+struct dLink_base {
+    dLink_base* prev;   // previous link
+    dLink_base* succ;   // successor (next) link
+
+    Node* node() { return static_cast<Node*>(this); }
+    const Node* node() const { return static_cast<const Node*>(this); }
+};
+
+// the link of a singly linked node without the value
+template<typename Node>
+struct sLink_base {
+    sLink_base* succ;   // successor (next) link
+
+    Node* node() { return static_cast<Node*>(this); }
+    const Node* node() const { return static_cast<const Node*>(this); }
+};
+
 // Link base for doubly linked list
 template<typename Elem>
-struct dLink {
+struct dLink : dLink_base<dLink<Elem>> {
     dLink(const Elem& v, dLink* p = nullptr, dLink* s = nullptr)
-        : val{ v }, prev{ p }, succ{ s } { }
+        : dLink_base<dLink>{ p, s }, val{ v } { }
+
+    template<typename... Args>
+    explicit dLink(std::in_place_t, Args&&... args)   // build val in place from args
+        : dLink_base<dLink>{ nullptr, nullptr }, val(std::forward<Args>(args)...) { }
 
-    dLink* prev;     // previous node
-    dLink* succ;     // successor (next) node
     Elem val;       // the value
-};
\ No newline at end of file
+};
+
+//==============================================================================
+// Relinking helpers shared by the lists. They work on chains of link bases
+// (succ and node()), terminated by nullptr and holding real nodes only, and
+// never copy or move a value.
+
+template<typename Link, typename Compare>
+Link* merge_links(Link* a, Link* b, Compare& comp)
+// merge two sorted chains; stable: on ties the node from a comes first
+{
+    Link* result = nullptr;
+    Link** tail = &result;
+    while (a && b) {
+        if (comp(b->node()->val, a->node()->val)) {
+            *tail = b;
+            b = b->succ;
+        }
+        else {
+            *tail = a;
+            a = a->succ;
+        }
+        tail = &(*tail)->succ;
+    }
+    *tail = a ? a : b;
+    return result;
+}
+
+template<typename Link, typename Compare>
+Link* sort_links(Link* head, Compare& comp)
+// stable bottom-up merge sort: bins[i] holds a sorted run of 2^i nodes
+{
+    Link* bins[64] = {};
+    while (head) {
+        Link* run = head;
+        head = head->succ;
+        run->succ = nullptr;
+
+        std::size_t i = 0;
+        for (; bins[i]; ++i) {              // carry, like adding 1 to a binary counter
+            run = merge_links(bins[i], run, comp);
+            bins[i] = nullptr;
+        }
+        bins[i] = run;
+    }
+
+    Link* result = nullptr;
+    for (Link* run : bins)                  // higher bins hold the earlier nodes
+        if (run) result = merge_links(run, result, comp);
+    return result;
+}
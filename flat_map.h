@@ -0,0 +1,464 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+/**
+ * flat_set dan flat_map: container asosiatif yang disimpan terurut di dalam
+ * vector, tanpa node dan tanpa alokasi per elemen. Key dan value disimpan di
+ * array terpisah, jadi pencarian hanya menyentuh array key:
+ *
+ *     flat_map<int, Price> prices(rows.begin(), rows.end());  // sort once, drop duplicates
+ *     if (auto it = prices.find(id); it != prices.end()) ...
+ *     prices.insert_range(batch.begin(), batch.end());        // one merge, not n inserts
+ *
+ *     flat_set<uint64_t, std::less<>, flat_layout::eytzinger> seen;
+ *
+ * Lookups are branchless binary searches. With flat_layout::eytzinger the
+ * keys are kept in breadth-first order of an implicit search tree instead,
+ * so the first levels of every search share a few cache lines; lookups in
+ * big tables get faster, but every insert or erase rebuilds the layout.
+ * Iteration is always in key order. On duplicate keys the first one wins:
+ * the existing element, or the earliest one of a batch.
+ */
+
+enum class flat_layout {
+    sorted,     // keys in ascending order
+    eytzinger   // keys in breadth-first order of a search tree; for read-mostly tables
+};
+
+struct flat_no_values { };  // the value column of a flat_set
+
+template<typename Key, typename T, typename Compare, flat_layout L>
+class flat_tree {
+    // Shared by flat_set (T = void) and flat_map: the key column, the value
+    // column, the layout and the searches. Positions are indices into the
+    // columns, in layout order.
+protected:
+    static constexpr bool has_values = !std::is_void<T>::value;
+    using value_column = std::conditional_t<has_values, vector<std::conditional_t<has_values, T, char>>, flat_no_values>;
+    static_assert(!std::is_same<Key, bool>::value && !std::is_same<T, bool>::value,
+        "vector<bool> is bit-packed; use char for a bool key or value");
+
+public:
+    using key_type = Key;
+    using key_compare = Compare;
+    using size_type = size_t;
+
+    static constexpr size_type npos = ~size_type{ 0 };
+
+    size_type size() const { return keys.size(); }
+    bool empty() const { return keys.size() == 0; }
+
+    void reserve(size_type n)
+    {
+        keys.reserve(n);
+        if constexpr (has_values) vals.reserve(n);
+    }
+
+    void clear()
+    {
+        keys.erase(keys.begin(), keys.end());
+        if constexpr (has_values) vals.erase(vals.begin(), vals.end());
+    }
+
+    bool contains(const Key& k) const { return find_pos(k) != npos; }
+    size_type count(const Key& k) const { return contains(k) ? 1 : 0; }
+
+    bool erase(const Key& k)
+    // remove k; false if it wasn't there
+    {
+        if (!contains(k)) return false;
+        to_sorted();
+        size_type i = sorted_lower(k);
+        keys.erase(keys.begin() + i);
+        if constexpr (has_values) vals.erase(vals.begin() + i);
+        to_layout();
+        return true;
+    }
+
+protected:
+    static bool less(const Key& a, const Key& b) { return Compare{}(a, b); }
+
+    size_type find_pos(const Key& k) const
+    // position of k, or npos
+    {
+        size_type p = lower_pos(k);
+        return p != npos && !less(k, keys[p]) ? p : npos;
+    }
+
+    size_type lower_pos(const Key& k) const
+    // position of the first key not less than k, or npos
+    {
+        if constexpr (L == flat_layout::sorted) {
+            size_type i = sorted_lower(k);
+            return i == keys.size() ? npos : i;
+        }
+        else {
+            // node k - 1 has children 2k - 1 and 2k; each comparison becomes the next
+            // bit of the path, then the path is cut back to the last left turn
+            size_type n = keys.size();
+            size_type i = 1;
+            while (i <= n)
+                i = 2 * i + less(keys[i - 1], k);
+            i >>= lowest_bit(~static_cast<bit_word>(i)) + 1;
+            return i == 0 ? npos : i - 1;
+        }
+    }
+
+    size_type sorted_lower(const Key& k) const
+    // lower bound in sorted keys: halve the range without a branch, the
+    // compiler turns the choice of base into a conditional move
+    {
+        size_type n = keys.size();
+        if (n == 0) return 0;
+        const Key* base = keys.begin();
+        while (n > 1) {
+            size_type half = n / 2;
+            base = less(base[half], k) ? base + half : base;
+            n -= half;
+        }
+        return (base - keys.begin()) + less(*base, k);
+    }
+
+    size_type first_pos() const
+    // position of the smallest key, npos when empty
+    {
+        size_type n = keys.size();
+        if (n == 0) return npos;
+        if constexpr (L == flat_layout::sorted)
+            return 0;
+        else {
+            size_type i = 1;
+            while (2 * i <= n) i *= 2;     // leftmost node
+            return i - 1;
+        }
+    }
+
+    size_type next_pos(size_type p) const
+    // position of the next key in key order, npos after the largest
+    {
+        size_type n = keys.size();
+        if constexpr (L == flat_layout::sorted)
+            return p + 1 < n ? p + 1 : npos;
+        else {
+            size_type i = p + 1;
+            if (2 * i + 1 <= n) {       // leftmost node of the right subtree
+                i = 2 * i + 1;
+                while (2 * i <= n) i *= 2;
+            }
+            else                        // up past every right turn, then once more
+                i >>= lowest_bit(~static_cast<bit_word>(i)) + 1;
+            return i == 0 ? npos : i - 1;
+        }
+    }
+
+    template<typename... V>
+    size_type insert_row(const Key& k, V&&... v)
+    // add k (and its value) unless k is there; returns the position of k
+    {
+        if (size_type p = find_pos(k); p != npos) return p;
+        to_sorted();
+        size_type i = sorted_lower(k);
+        keys.insert(keys.begin() + i, k);
+        if constexpr (has_values) {
+            try {
+                vals.insert(vals.begin() + i, T(std::forward<V>(v)...));
+            }
+            catch (...) {
+                keys.erase(keys.begin() + i);
+                to_layout();
+                throw;
+            }
+        }
+        to_layout();
+        return L == flat_layout::sorted ? i : find_pos(k);
+    }
+
+    void merge_sorted(vector<Key>& add_keys, value_column& add_vals)
+    // merge a batch sorted by key (stably, so the first of equal keys comes
+    // first) in one pass; existing keys and the first of a run of equal keys win
+    {
+        to_sorted();
+        size_type n = keys.size();
+        size_type m = add_keys.size();
+        vector<Key> out_keys;
+        value_column out_vals;
+        out_keys.reserve(n + m);
+        if constexpr (has_values) out_vals.reserve(n + m);
+
+        auto take = [&](vector<Key>& ks, value_column& vs, size_type i) {
+            out_keys.push_back(std::move(ks[i]));
+            if constexpr (has_values) out_vals.push_back(std::move(vs[i]));
+        };
+
+        size_type i = 0;
+        size_type j = 0;
+        while (j < m) {
+            if (i < n && !less(add_keys[j], keys[i])) {
+                if (!less(keys[i], add_keys[j])) ++j;   // already there: the batch's copy is dropped
+                else take(keys, vals, i++);
+                continue;
+            }
+            take(add_keys, add_vals, j++);
+            while (j < m && !less(out_keys.back(), add_keys[j])) ++j;   // duplicates within the batch
+        }
+        for (; i < n; ++i) take(keys, vals, i);
+
+        keys = std::move(out_keys);
+        if constexpr (has_values) vals = std::move(out_vals);
+        to_layout();
+    }
+
+    void to_sorted()
+    // rearrange the columns into key order; no-op for the sorted layout
+    {
+        if constexpr (L == flat_layout::eytzinger) {
+            vector<size_type> order;    // order[r] = position of the key of rank r
+            order.reserve(keys.size());
+            for (size_type p = first_pos(); p != npos; p = next_pos(p))
+                order.push_back(p);
+            gather(order);
+        }
+    }
+
+    void to_layout()
+    // rearrange sorted columns into the layout; no-op for the sorted layout
+    {
+        if constexpr (L == flat_layout::eytzinger) {
+            vector<size_type> rank(keys.size(), 0);   // rank[p] = rank of the key going to position p
+            size_type r = 0;
+            for (size_type p = first_pos(); p != npos; p = next_pos(p))
+                rank[p] = r++;
+            gather(rank);
+        }
+    }
+
+    void gather(const vector<size_type>& from)
+    // column[p] = old column[from[p]], for both columns
+    {
+        vector<Key> k;
+        k.reserve(keys.size());
+        for (size_type p = 0; p < from.size(); ++p) k.push_back(std::move(keys[from[p]]));
+        if constexpr (has_values) {
+            value_column v;
+            v.reserve(vals.size());
+            for (size_type p = 0; p < from.size(); ++p) v.push_back(std::move(vals[from[p]]));
+            vals = std::move(v);
+        }
+        keys = std::move(k);
+    }
+
+    vector<Key> keys;       // in layout order
+    value_column vals;      // vals[p] belongs to keys[p]
+};
+
+//==============================================================================
+
+template<typename Key, typename Compare = std::less<Key>, flat_layout L = flat_layout::sorted>
+class flat_set : public flat_tree<Key, void, Compare, L> {
+    using base = flat_tree<Key, void, Compare, L>;
+public:
+    using typename base::size_type;
+    using value_type = Key;
+
+    class iterator; // member type: iterator
+
+    flat_set() { }
+
+    flat_set(std::initializer_list<Key> lst)
+    {
+        insert_range(lst.begin(), lst.end());
+    }
+
+    template<typename Iter, typename = typename std::iterator_traits<Iter>::iterator_category>
+    flat_set(Iter first, Iter last)
+    // bulk construction: sort once, then drop duplicates
+    {
+        insert_range(first, last);
+    }
+
+    iterator begin() const { return iterator(this, this->first_pos()); }
+    iterator end() const { return iterator(this, base::npos); }
+
+    iterator find(const Key& k) const { return iterator(this, this->find_pos(k)); }
+    iterator lower_bound(const Key& k) const { return iterator(this, this->lower_pos(k)); }
+
+    bool insert(const Key& k)
+    // false if k was already there
+    {
+        size_type n = this->size();
+        this->insert_row(k);
+        return this->size() != n;
+    }
+
+    template<typename Iter>
+    void insert_range(Iter first, Iter last)
+    // add [first, last) with a single merge
+    {
+        vector<Key> add;
+        for (; first != last; ++first)
+            add.push_back(*first);
+        std::stable_sort(add.begin(), add.end(), Compare{});
+        flat_no_values none;
+        this->merge_sorted(add, none);
+    }
+};
+
+template<typename Key, typename Compare, flat_layout L>
+class flat_set<Key, Compare, L>::iterator {
+public:
+    iterator(const flat_set* s, size_t p)
+        : s{ s }, pos{ p } { }
+
+    iterator& operator++() { pos = s->next_pos(pos); return *this; }  // forward, in key order
+
+    const Key& operator*() const { return s->keys[pos]; }
+    const Key* operator->() const { return &s->keys[pos]; }
+
+    bool operator==(const iterator& b) const { return pos == b.pos; }
+    bool operator!=(const iterator& b) const { return pos != b.pos; }
+
+private:
+    const flat_set* s;  // the set
+    size_t pos;         // position in layout order, npos at end()
+};
+
+//==============================================================================
+
+template<typename Key, typename T, typename Compare = std::less<Key>, flat_layout L = flat_layout::sorted>
+class flat_map : public flat_tree<Key, T, Compare, L> {
+    using base = flat_tree<Key, T, Compare, L>;
+public:
+    using typename base::size_type;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+
+    class iterator;         // member type: iterator
+    class const_iterator;   // member type: iterator over a const map
+
+    flat_map() { }
+
+    flat_map(std::initializer_list<value_type> lst)
+    {
+        insert_range(lst.begin(), lst.end());
+    }
+
+    template<typename Iter, typename = typename std::iterator_traits<Iter>::iterator_category>
+    flat_map(Iter first, Iter last)
+    // bulk construction: sort once, then drop duplicates
+    {
+        insert_range(first, last);
+    }
+
+    iterator begin() { return iterator(this, this->first_pos()); }
+    iterator end() { return iterator(this, base::npos); }
+    const_iterator begin() const { return const_iterator(this, this->first_pos()); }
+    const_iterator end() const { return const_iterator(this, base::npos); }
+
+    iterator find(const Key& k) { return iterator(this, this->find_pos(k)); }
+    const_iterator find(const Key& k) const { return const_iterator(this, this->find_pos(k)); }
+    iterator lower_bound(const Key& k) { return iterator(this, this->lower_pos(k)); }
+    const_iterator lower_bound(const Key& k) const { return const_iterator(this, this->lower_pos(k)); }
+
+    T& at(const Key& k)
+    {
+        size_type p = this->find_pos(k);
+        if (p == base::npos) throw std::out_of_range("flat_map: key not found");
+        return this->vals[p];
+    }
+
+    const T& at(const Key& k) const
+    {
+        size_type p = this->find_pos(k);
+        if (p == base::npos) throw std::out_of_range("flat_map: key not found");
+        return this->vals[p];
+    }
+
+    T& operator[](const Key& k) { return this->vals[this->insert_row(k)]; }   // inserts T{} if k is missing
+
+    template<typename V>
+    bool insert(const Key& k, V&& v)
+    // false (and v unused) if k was already there
+    {
+        size_type n = this->size();
+        this->insert_row(k, std::forward<V>(v));
+        return this->size() != n;
+    }
+
+    bool insert(const value_type& kv) { return insert(kv.first, kv.second); }
+
+    template<typename Iter>
+    void insert_range(Iter first, Iter last)
+    // add the (key, value) pairs of [first, last) with a single merge
+    {
+        vector<value_type> add;
+        for (; first != last; ++first)
+            add.push_back(*first);
+        std::stable_sort(add.begin(), add.end(),
+            [](const value_type& a, const value_type& b) { return Compare{}(a.first, b.first); });
+
+        vector<Key> add_keys;
+        vector<T> add_vals;
+        add_keys.reserve(add.size());
+        add_vals.reserve(add.size());
+        for (auto& kv : add) {
+            add_keys.push_back(std::move(kv.first));
+            add_vals.push_back(std::move(kv.second));
+        }
+        this->merge_sorted(add_keys, add_vals);
+    }
+};
+
+template<typename Key, typename T, typename Compare, flat_layout L>
+class flat_map<Key, T, Compare, L>::iterator {
+public:
+    iterator(flat_map* m, size_t p)
+        : m{ m }, pos{ p } { }
+
+    iterator& operator++() { pos = m->next_pos(pos); return *this; }  // forward, in key order
+
+    std::pair<const Key&, T&> operator*() const { return { m->keys[pos], m->vals[pos] }; }
+
+    const Key& key() const { return m->keys[pos]; }
+    T& value() const { return m->vals[pos]; }
+
+    bool operator==(const iterator& b) const { return pos == b.pos; }
+    bool operator!=(const iterator& b) const { return pos != b.pos; }
+
+private:
+    friend class const_iterator;
+
+    flat_map* m;    // the map
+    size_t pos;     // position in layout order, npos at end()
+};
+
+template<typename Key, typename T, typename Compare, flat_layout L>
+class flat_map<Key, T, Compare, L>::const_iterator {
+public:
+    const_iterator(const flat_map* m, size_t p)
+        : m{ m }, pos{ p } { }
+
+    const_iterator(const iterator& it)
+        : m{ it.m }, pos{ it.pos } { }
+
+    const_iterator& operator++() { pos = m->next_pos(pos); return *this; }  // forward, in key order
+
+    std::pair<const Key&, const T&> operator*() const { return { m->keys[pos], m->vals[pos] }; }
+
+    const Key& key() const { return m->keys[pos]; }
+    const T& value() const { return m->vals[pos]; }
+
+    bool operator==(const const_iterator& b) const { return pos == b.pos; }
+    bool operator!=(const const_iterator& b) const { return pos != b.pos; }
+
+private:
+    const flat_map* m;  // the map
+    size_t pos;         // position in layout order, npos at end()
+};
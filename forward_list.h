@@ -1,28 +1,49 @@
+#pragma once
+
 /**
  * homebrew foward_list
+ *
+ * A is rebound to the node type, so any allocator of Elem works, including
+ * std::pmr ones (see pmr::forward_list below).
  */
 
+#include <functional>
 #include <iostream>
 #include <initializer_list>
 #include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <dLink.h>
+#include "check.h"
 
 template<typename Elem>
-struct sLink {
+struct sLink : sLink_base<sLink<Elem>> {
     sLink(const Elem& v, sLink* s = nullptr)
-        : val{ v }, succ{ s } { }
+        : sLink_base<sLink>{ s }, val{ v } { }
+
+    template<typename... Args>
+    explicit sLink(std::in_place_t, Args&&... args)   // build val in place from args
+        : sLink_base<sLink>{ nullptr }, val(std::forward<Args>(args)...) { }
 
-    sLink* succ;     // successor (next) node
     Elem val;       // the value
 };
 
-template<typename Elem>
+template<typename Elem, typename A = std::allocator<Elem>>
 class forward_list {
 public:
-    forward_list()
-        : sz{ 0 }, first{ alloc.allocate(1) }, last{ alloc.allocate(1) }
+    using allocator_type = A;
+    using node_allocator = typename std::allocator_traits<A>::template rebind_alloc<sLink<Elem>>;
+    using node_traits = std::allocator_traits<node_allocator>;
+    using link = sLink_base<sLink<Elem>>;  // what the chain is made of; the sentinels are bare links
+
+    forward_list() noexcept(std::is_nothrow_default_constructible<node_allocator>::value)
+    {
+    }
+
+    explicit forward_list(const A& a) noexcept(std::is_nothrow_constructible<node_allocator, const A&>::value)
+        : alloc(a)
     {
-        first->succ = last;
-        last->succ = nullptr;
     }
 
     forward_list(std::initializer_list<Elem> lst)
@@ -37,31 +58,30 @@ public:
     }
 
     forward_list(const forward_list& fl)
-        : forward_list()
+        : alloc(node_traits::select_on_container_copy_construction(fl.alloc))
     {
         // iterate fl and copy the values
-        iterator iter{ before_begin() };
-        for (auto i = fl.first->succ; i != fl.last; i = i->succ) {
-            iter = insert_after(iter, i->val);
+        try {
+            iterator iter{ before_begin() };
+            for (auto i = fl.first->succ; i != fl.last; i = i->succ) {
+                iter = insert_after(iter, i->node()->val);
+            }
+        }
+        catch (...) {
+            clear();    // not delegating, so the destructor won't run
+            throw;
         }
     }
 
-    forward_list(forward_list&& fl)
-        : first{ fl.first }, last{ fl.last }, sz{ fl.sz }
+    forward_list(forward_list&& fl) noexcept
+        : alloc(fl.alloc)   // share fl's allocator: the nodes we steal came from it
     {
-        // give fl new representation
-        fl.first = alloc.allocate(1);
-        fl.last = alloc.allocate(1);
-        fl.first->succ = fl.last;
-        fl.last->succ = nullptr;
-        fl.sz = 0;
+        steal(fl);
     }
 
     ~forward_list()
     {
         clear();
-        alloc.deallocate(first, 1);
-        alloc.deallocate(last, 1);	// deallocate last
     }
 
     forward_list& operator=(const forward_list& fl)
@@ -72,32 +92,32 @@ public:
         // iterate fl and copy the values
         iterator iter{ before_begin() };
         for (auto i = fl.first->succ; i != fl.last; i = i->succ) {
-            iter = insert_after(iter, i->val);
+            iter = insert_after(iter, i->node()->val);
         }
 
         return *this;
     }
 
-    forward_list& operator=(forward_list&& fl)
+    forward_list& operator=(forward_list&& fl) noexcept(node_traits::propagate_on_container_move_assignment::value
+        || node_traits::is_always_equal::value)
     {
         if (this == &fl) return *this;  // assignment to self
 
-        // clear all contents including first and last
+        // clear current content excluding first and last
         clear();
-        alloc.deallocate(first,1);
-        alloc.deallocate(last,1);
-        
-        // steal representation
-        first = fl.first;
-        last = fl.last;
-        sz = fl.sz;
-
-        // give fl new representation
-        fl.first = alloc.allocate(1);
-        fl.last = alloc.allocate(1);
-        fl.first->succ = fl.last;
-        fl.last->succ = nullptr;
-        fl.sz = 0;
+
+        // every node must stay with the allocator it came from: take fl's
+        // allocator along with its nodes if the allocator allows it (pmr
+        // ones don't), else steal only from an equal allocator
+        if constexpr (node_traits::propagate_on_container_move_assignment::value)
+            std::swap(alloc, fl.alloc);
+        else if (alloc != fl.alloc) {
+            for (auto p = fl.first->succ; p != fl.last; p = p->succ)
+                emplace_back(std::move(p->node()->val));
+            fl.clear();
+            return *this;
+        }
+        steal(fl);
 
         return *this;
     }
@@ -112,12 +132,21 @@ public:
     const iterator end() const { return iterator(last, first, last); }
 
     iterator insert_after(iterator p, const Elem& v); // insert v into forward_list after p
+    iterator insert_after(iterator p, Elem&& v);
+    template<typename... Args>
+    iterator emplace_after(iterator p, Args&&... args); // construct a new elem after p from args
     iterator insert_before(iterator p, const Elem& v); // insert v into forward_list before p
     iterator erase_after(iterator p);  // remove elem after p from the forward_list
     iterator erase(iterator p);  // remove p from the forward_list
 
     void push_back(const Elem& v);
     void push_front(const Elem& v);
+    void push_back(Elem&& v);
+    void push_front(Elem&& v);
+    template<typename... Args>
+    Elem& emplace_back(Args&&... args);
+    template<typename... Args>
+    Elem& emplace_front(Args&&... args);
     void pop_front();
     void pop_back();
 
@@ -128,199 +157,411 @@ public:
 
     void clear();   // empty list
 
+    // the operations below only relink nodes; no element is copied or moved
+    void splice_after(iterator p, forward_list& fl); // move all of fl after p
+    void splice_after(iterator p, forward_list& fl, iterator it); // move the elem after it
+    void splice_after(iterator p, forward_list& fl, iterator b, iterator e); // move (b, e)
+    template<typename Compare = std::less<>>
+    void merge(forward_list& fl, Compare comp = Compare{}); // merge sorted fl into this sorted list
+    template<typename Compare = std::less<>>
+    void sort(Compare comp = Compare{}); // stable merge sort
+    void reverse();
+    template<typename Pred = std::equal_to<>>
+    void unique(Pred same = Pred{}); // erase consecutive duplicates
+
     int size() const { return sz; }
 
 private:
-    size_t sz;
-    sLink<Elem>* first;
-    sLink<Elem>* last;
-    std::allocator<sLink<Elem>> alloc;
+    void check_splice(const forward_list& fl) const;
+    void steal(forward_list& fl) noexcept; // take fl's nodes; *this must be empty
+    link* detach(); // take the elements out as a nullptr-terminated chain
+    void attach(link* head); // make such a chain the whole list
+
+    node_allocator alloc;
+    size_t sz = 0;
+    // an empty list: first connected to last
+    link first_base{ &last_base };   // storage of first
+    link last_base{ nullptr };       // storage of last
+    link* first{ &first_base };
+    link* last{ &last_base };
+    link* tail{ first };     // elem before last (first when empty), for O(1) push_back and back
 };
 
-template<typename Elem> // requires Element<Elem>() (§19.3.3)
-class forward_list<Elem>::iterator {
+namespace pmr {
+    template<typename Elem>
+    using forward_list = ::forward_list<Elem, std::pmr::polymorphic_allocator<Elem>>;
+}
+
+template<typename Elem, typename A> // requires Element<Elem>() (§19.3.3)
+class forward_list<Elem, A>::iterator {
 public:
-    iterator(sLink<Elem>* p, sLink<Elem>* first, sLink<Elem>* last)
+#if HOMEMADE_CHECK_LEVEL > 0
+    iterator(link* p, link* first, link* last)
         : curr{ p }, first{ first }, last{ last } { }
+#else
+    iterator(link* p, link*, link*)  // unchecked: just the pointer
+        : curr{ p } { }
+#endif
 
     // only overloaded for prefix increment
     iterator& operator++()  // forward
     {
-        if (curr == last)
-            throw std::out_of_range("increment beyond end()");
+        HOMEMADE_CHECK(curr != last, throw std::out_of_range("increment beyond end()"));
         curr = curr->succ;
         return *this;
     }
     Elem& operator*() // get value (dereference)
     {
-        if (curr == first || curr == last) // first and last are not to be accessed
-            throw std::out_of_range("dereference beyond range");
-        return curr->val;
+        HOMEMADE_CHECK(curr != first && curr != last, // first and last are not to be accessed
+            throw std::out_of_range("dereference beyond range"));
+        return curr->node()->val;
     }
     const Elem& operator*() const // get value (dereference)
     {
-        if (curr == first || curr == last) // first and last are not to be accessed
-            throw std::out_of_range("dereference beyond range");
-        return curr->val;
+        HOMEMADE_CHECK(curr != first && curr != last, // first and last are not to be accessed
+            throw std::out_of_range("dereference beyond range"));
+        return curr->node()->val;
     }
-    sLink<Elem>* operator->() { return curr; }
+    sLink<Elem>* operator->() { return curr->node(); }  // only for an element, not first or last
 
     bool operator==(const iterator& b) const { return curr == b.curr; }
     bool operator!=(const iterator& b) const { return curr != b.curr; }
     explicit operator bool() const { return curr; }
 
-    sLink<Elem>* ptr() const { return curr; }
+    link* ptr() const { return curr; }
 
 private:
-    sLink<Elem>* curr; // current link
+    link* curr; // current link
+#if HOMEMADE_CHECK_LEVEL > 0
     // storing first last to impose iterator check
-    sLink<Elem>* first;
-    sLink<Elem>* last;
+    link* first;
+    link* last;
+#endif
 };
 
 // may throw access violation exception
-template<typename Elem>
-typename forward_list<Elem>::iterator forward_list<Elem>::insert_after(
-    forward_list<Elem>::iterator p, const Elem& v)
+template<typename Elem, typename A>
+typename forward_list<Elem, A>::iterator forward_list<Elem, A>::insert_after(
+    forward_list<Elem, A>::iterator p, const Elem& v)
+{
+    return emplace_after(p, v);
+}
+
+template<typename Elem, typename A>
+typename forward_list<Elem, A>::iterator forward_list<Elem, A>::insert_after(
+    forward_list<Elem, A>::iterator p, Elem&& v)
+{
+    return emplace_after(p, std::move(v));
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+typename forward_list<Elem, A>::iterator forward_list<Elem, A>::emplace_after(
+    forward_list<Elem, A>::iterator p, Args&&... args)
 {
     if (p == end()) throw std::out_of_range("inserting beyond end()");
 
-    std::unique_ptr<sLink<Elem>> newLink{ alloc.allocate(1) };// allocate
-    alloc.construct(newLink.get(), sLink<Elem>(v));			// construct
+    sLink<Elem>* newLink = node_traits::allocate(alloc, 1);   // allocate
+    try {
+        node_traits::construct(alloc, newLink, std::in_place, std::forward<Args>(args)...);  // construct
+    }
+    catch (...) {
+        node_traits::deallocate(alloc, newLink, 1);
+        throw;
+    }
 
-    newLink->succ = p->succ;
-    p->succ = newLink.get();
+    newLink->succ = p.ptr()->succ;
+    p.ptr()->succ = newLink;
+    if (p.ptr() == tail) tail = newLink;
 
     ++sz;
 
-    return iterator(newLink.release(), first, last);
+    return iterator(newLink, first, last);
 }
 
-template<typename Elem>
-typename forward_list<Elem>::iterator forward_list<Elem>::insert_before(
-    forward_list<Elem>::iterator p, const Elem& v)
+template<typename Elem, typename A>
+typename forward_list<Elem, A>::iterator forward_list<Elem, A>::insert_before(
+    forward_list<Elem, A>::iterator p, const Elem& v)
 {
     if (p == before_begin()) throw std::out_of_range("inserting beyond before_begin()");
 
     auto it = before_begin();
-    for (; it->succ != p.ptr(); ++it);  // iterate to elem before p
+    for (; it.ptr()->succ != p.ptr(); ++it);  // iterate to elem before p
     return insert_after(it, v);
 }
 
 // may throw access violation exception
 // invalidates erased element's iterator
-template<typename Elem>
-typename forward_list<Elem>::iterator forward_list<Elem>::erase_after(
-    forward_list<Elem>::iterator p)
+template<typename Elem, typename A>
+typename forward_list<Elem, A>::iterator forward_list<Elem, A>::erase_after(
+    forward_list<Elem, A>::iterator p)
 {
     if (sz == 0) throw std::runtime_error("empty list");
-    if (p->succ == last) throw std::out_of_range("attempting to erase end()");
+    if (p.ptr()->succ == last) throw std::out_of_range("attempting to erase end()");
     if (p == end()) throw std::out_of_range("attempting to erase after end()");
 
-    auto temp = p->succ;    // store iterator to be erased
-    p->succ = p->succ->succ;
+    link* temp = p.ptr()->succ;    // store link to be erased
+    p.ptr()->succ = temp->succ;
+    if (temp == tail) tail = p.ptr();
 
-    alloc.destroy(temp);
-    alloc.deallocate(temp, 1);
+    node_traits::destroy(alloc, temp->node());
+    node_traits::deallocate(alloc, temp->node(), 1);
 
     --sz;
 
-    return iterator(p->succ, first, last);
+    return iterator(p.ptr()->succ, first, last);
 }
 
 // don't use before_begin as p
 // invalidates erased element's iterator
-template<typename Elem>
-typename forward_list<Elem>::iterator forward_list<Elem>::erase(
-    forward_list<Elem>::iterator p)
+template<typename Elem, typename A>
+typename forward_list<Elem, A>::iterator forward_list<Elem, A>::erase(
+    forward_list<Elem, A>::iterator p)
 {
     if (sz == 0) throw std::runtime_error("empty list");
     if (p == before_begin()) throw std::out_of_range("attempting to erase before_begin()");
     if (p == end()) throw std::out_of_range("attempting to erase end()");
 
     auto it = before_begin();
-    for (; it->succ != p.ptr(); ++it);  // iterate to elem before p
+    for (; it.ptr()->succ != p.ptr(); ++it);  // iterate to elem before p
     return erase_after(it);
 }
 
-template<typename Elem>
-void forward_list<Elem>::push_front(const Elem& v)
+template<typename Elem, typename A>
+void forward_list<Elem, A>::push_front(const Elem& v)
 {
     insert_after(before_begin(), v);
 }
 
-template<typename Elem>
-void forward_list<Elem>::push_back(const Elem& v)
+template<typename Elem, typename A>
+void forward_list<Elem, A>::push_back(const Elem& v)
 {
-    auto it = before_begin();
-    for (; it->succ != last; ++it);  // iterate to elem before last
-    insert_after(it, v);
+    emplace_back(v);
 }
 
-template<typename Elem>
-void forward_list<Elem>::pop_front()
+template<typename Elem, typename A>
+void forward_list<Elem, A>::push_front(Elem&& v)
+{
+    insert_after(before_begin(), std::move(v));
+}
+
+template<typename Elem, typename A>
+void forward_list<Elem, A>::push_back(Elem&& v)
+{
+    emplace_back(std::move(v));
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+Elem& forward_list<Elem, A>::emplace_front(Args&&... args)
+{
+    return *emplace_after(before_begin(), std::forward<Args>(args)...);
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+Elem& forward_list<Elem, A>::emplace_back(Args&&... args)
+{
+    return *emplace_after(iterator(tail, first, last), std::forward<Args>(args)...);
+}
+
+template<typename Elem, typename A>
+void forward_list<Elem, A>::pop_front()
 {
     erase_after(before_begin());
 }
 
-template<typename Elem>
-void forward_list<Elem>::pop_back()
+template<typename Elem, typename A>
+void forward_list<Elem, A>::pop_back()
 {
     if (sz == 0) throw std::runtime_error("empty list");
 
     auto it = before_begin();
-    for (; it->succ->succ != last; ++it);  // iterate to 2 elems before last
+    for (; it.ptr()->succ->succ != last; ++it);  // iterate to 2 elems before last
     erase_after(it);
 }
 
-template<typename Elem>
-Elem& forward_list<Elem>::front()
+template<typename Elem, typename A>
+Elem& forward_list<Elem, A>::front()
 {
     if (sz == 0) throw std::runtime_error("empty forward_list");
     return begin()->val;
 }
 
-template<typename Elem>
-const Elem& forward_list<Elem>::front() const
+template<typename Elem, typename A>
+const Elem& forward_list<Elem, A>::front() const
 {
     if (sz == 0) throw std::runtime_error("empty forward_list");
     return begin()->val;
 }
 
-template<typename Elem>
-Elem& forward_list<Elem>::back()
+template<typename Elem, typename A>
+Elem& forward_list<Elem, A>::back()
 {
     if (sz == 0) throw std::runtime_error("empty forward_list");
-    auto it = begin();
-    for (; it->succ != last; ++it);  // iterate to elem before last
-
-    return it->val;
+    return tail->node()->val;
 }
 
-template<typename Elem>
-const Elem& forward_list<Elem>::back() const
+template<typename Elem, typename A>
+const Elem& forward_list<Elem, A>::back() const
 {
     if (sz == 0) throw std::runtime_error("empty forward_list");
-    auto it = begin();
-    for (; it->succ != last; ++it);  // iterate to elem before last
-
-    return it->val;
+    return tail->node()->val;
 }
 
-template<typename Elem>
-void forward_list<Elem>::clear()
+template<typename Elem, typename A>
+void forward_list<Elem, A>::clear()
 {
-    sLink<Elem>* temp = nullptr; // storing p->succ, because after deleted, p->succ causes segfault
-    for (sLink<Elem>* p = begin().ptr(); p != last; p = temp) {
+    link* temp = nullptr; // storing p->succ, because after deleted, p->succ causes segfault
+    for (link* p = first->succ; p != last; p = temp) {
         temp = p->succ;
-        alloc.destroy(p);
-        alloc.deallocate(p, 1);
+        node_traits::destroy(alloc, p->node());
+        node_traits::deallocate(alloc, p->node(), 1);
     }
 
     first->succ = last;
+    tail = first;
     sz = 0;
 }
 
+template<typename Elem, typename A>
+void forward_list<Elem, A>::check_splice(const forward_list<Elem, A>& fl) const
+{
+    // nodes must be freed by the allocator that made them
+    if (alloc != fl.alloc) throw std::runtime_error("splice between lists with different allocators");
+}
+
+template<typename Elem, typename A>
+void forward_list<Elem, A>::steal(forward_list<Elem, A>& fl) noexcept
+{
+    if (fl.sz == 0) return;
+
+    // take the chain between fl's sentinels and hang it between ours
+    sz = fl.sz;
+    first->succ = fl.first->succ;
+    tail = fl.tail;
+    tail->succ = last;
+
+    // set fl's first to connect to its last
+    fl.first->succ = fl.last;
+    fl.tail = fl.first;
+    fl.sz = 0;
+}
+
+template<typename Elem, typename A>
+typename forward_list<Elem, A>::link* forward_list<Elem, A>::detach()
+{
+    if (sz == 0) return nullptr;
+    link* head = first->succ;
+    tail->succ = nullptr;
+    first->succ = last;
+    tail = first;
+    return head;
+}
+
+template<typename Elem, typename A>
+void forward_list<Elem, A>::attach(link* head)
+{
+    link* p = first;
+    for (p->succ = head; p->succ; p = p->succ);
+    p->succ = last;
+    tail = p;
+}
+
+template<typename Elem, typename A>
+void forward_list<Elem, A>::splice_after(forward_list<Elem, A>::iterator p,
+    forward_list<Elem, A>& fl)
+{
+    if (this == &fl || fl.sz == 0) return;
+    splice_after(p, fl, fl.before_begin(), fl.end());
+}
+
+template<typename Elem, typename A>
+void forward_list<Elem, A>::splice_after(forward_list<Elem, A>::iterator p,
+    forward_list<Elem, A>& fl, forward_list<Elem, A>::iterator it)
+{
+    if (it == fl.end() || it.ptr()->succ == fl.last) throw std::out_of_range("attempting to splice end()");
+    if (p == it || p.ptr() == it.ptr()->succ) return;
+    iterator e{ it.ptr()->succ->succ, fl.first, fl.last };
+    splice_after(p, fl, it, e);
+}
+
+template<typename Elem, typename A>
+void forward_list<Elem, A>::splice_after(forward_list<Elem, A>::iterator p,
+    forward_list<Elem, A>& fl, forward_list<Elem, A>::iterator b, forward_list<Elem, A>::iterator e)
+{
+    if (p == end()) throw std::out_of_range("splicing after end()");
+    if (b == e || b.ptr()->succ == e.ptr()) return;    // (b, e) is empty
+    check_splice(fl);
+
+    // find the last node of (b, e), counting it if it changes lists
+    size_t n = 1;
+    link* end = b.ptr()->succ;
+    for (; end->succ != e.ptr(); end = end->succ) ++n;
+    if (this != &fl) {
+        fl.sz -= n;
+        sz += n;
+    }
+
+    link* head = b.ptr()->succ;
+    b.ptr()->succ = e.ptr();    // unlink from fl
+    if (e.ptr() == fl.last) fl.tail = b.ptr();
+    end->succ = p.ptr()->succ;  // link in after p
+    p.ptr()->succ = head;
+    if (p.ptr() == tail) tail = end;
+}
+
+template<typename Elem, typename A>
+template<typename Compare>
+void forward_list<Elem, A>::merge(forward_list<Elem, A>& fl, Compare comp)
+{
+    if (this == &fl || fl.sz == 0) return;
+    check_splice(fl);
+
+    size_t n = fl.sz;
+    link* b = fl.detach();
+    fl.sz = 0;
+    attach(merge_links(detach(), b, comp));
+    sz += n;
+}
+
+template<typename Elem, typename A>
+template<typename Compare>
+void forward_list<Elem, A>::sort(Compare comp)
+{
+    if (sz < 2) return;
+    attach(sort_links(detach(), comp));
+}
+
+template<typename Elem, typename A>
+void forward_list<Elem, A>::reverse()
+{
+    link* prev = last;
+    link* p = first->succ;
+    if (sz != 0) tail = p;      // the first elem ends up last
+    while (p != last) {
+        link* next = p->succ;
+        p->succ = prev;
+        prev = p;
+        p = next;
+    }
+    first->succ = prev;
+}
+
+template<typename Elem, typename A>
+template<typename Pred>
+void forward_list<Elem, A>::unique(Pred same)
+{
+    if (sz < 2) return;
+    link* p = first->succ;
+    while (p->succ != last) {
+        if (same(p->node()->val, p->succ->node()->val))
+            erase_after(iterator(p, first, last));
+        else
+            p = p->succ;
+    }
+}
+
 //=========================================================================================
 
 template<typename Iterator> // requires Forward_iterator<Iterator>
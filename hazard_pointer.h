@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+#include "vector.h"
+
+/**
+ * Hazard pointer untuk container lock-free (lockfree_stack, lockfree_queue).
+ * Sebelum membaca node bersama, thread mengumumkan alamatnya di slot hazard;
+ * node yang sudah di-unlink hanya dibebaskan setelah tidak ada slot yang
+ * menunjuknya. Karena node yang masih dipegang tidak pernah dipakai ulang,
+ * masalah ABA pada compare_exchange juga hilang.
+ *
+ *     hazard_pointer hp;
+ *     Node* n = hp.protect(head);     // n stays valid until hp is reset or destroyed
+ *     ...
+ *     hazard_retire(unlinked);        // deleted once no hazard pointer holds it
+ */
+
+constexpr size_t hazard_slots = 512;           // hazard pointers held at once, over all threads
+constexpr size_t hazard_thread_cache = 4;      // slots a thread keeps between uses
+constexpr size_t hazard_retire_batch = 128;    // retired nodes per thread before a scan
+
+class hazard_domain {
+public:
+    static hazard_domain& global()
+    {
+        static hazard_domain d;
+        return d;
+    }
+
+    hazard_domain(const hazard_domain&) = delete;
+    hazard_domain& operator=(const hazard_domain&) = delete;
+
+    ~hazard_domain()
+    {
+        // no thread is left to hold a hazard pointer
+        for (auto& r : orphans) r.del(r.ptr);
+    }
+
+    std::atomic<void*>* acquire()
+    // claim a free slot, preferring the ones this thread gave back earlier
+    {
+        thread_state& t = local();
+        if (t.cached > 0) return t.cache[--t.cached];
+
+        for (auto& s : slots) {
+            bool used = false;
+            if (!s.used.load(std::memory_order_relaxed)
+                && s.used.compare_exchange_strong(used, true, std::memory_order_acquire))
+                return &s.ptr;
+        }
+        throw std::runtime_error("hazard_domain: all hazard pointer slots in use");
+    }
+
+    void release(std::atomic<void*>* p)
+    {
+        p->store(nullptr, std::memory_order_release);
+        thread_state& t = local();
+        if (t.cached < hazard_thread_cache) t.cache[t.cached++] = p;
+        else give_back(p);
+    }
+
+    void retire(void* p, void (*del)(void*))
+    // free p with del once no hazard pointer holds it
+    {
+        thread_state& t = local();
+        t.pending.push_back(retired{ p, del });
+        if (t.pending.size() >= hazard_retire_batch) scan(t.pending);
+    }
+
+private:
+    hazard_domain() = default;
+
+    struct alignas(cache_line) slot {
+        std::atomic<void*> ptr{ nullptr };  // first member: a slot is found from &ptr
+        std::atomic<bool> used{ false };
+    };
+
+    struct retired {
+        void* ptr;
+        void (*del)(void*);
+    };
+
+    struct thread_state {
+        // per thread bookkeeping; on thread exit the cached slots are given
+        // back and nodes still protected elsewhere are left to other threads
+        ~thread_state()
+        {
+            hazard_domain& d = global();
+            for (size_t i = 0; i < cached; ++i) d.give_back(cache[i]);
+            d.scan(pending);
+            std::lock_guard<std::mutex> lock{ d.m };
+            for (auto& r : pending) d.orphans.push_back(r);
+        }
+
+        std::atomic<void*>* cache[hazard_thread_cache];
+        size_t cached = 0;
+        vector<retired> pending;    // retired here, not yet deleted
+    };
+
+    static thread_state& local()
+    {
+        static thread_local thread_state t;
+        return t;
+    }
+
+    void give_back(std::atomic<void*>* p)
+    {
+        reinterpret_cast<slot*>(p)->used.store(false, std::memory_order_release);
+    }
+
+    void scan(vector<retired>& rs)
+    // delete every node of rs that no slot points to; the rest stay in rs
+    {
+        {
+            std::unique_lock<std::mutex> lock{ m, std::try_to_lock };
+            if (lock && orphans.size() > 0) {      // adopt nodes left by finished threads
+                for (auto& r : orphans) rs.push_back(r);
+                orphans.erase(orphans.begin(), orphans.end());
+            }
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);   // pairs with the fence in protect()
+        vector<void*> held;
+        held.reserve(hazard_slots);
+        for (auto& s : slots)
+            if (void* p = s.ptr.load(std::memory_order_acquire))
+                held.push_back(p);
+        std::sort(held.begin(), held.end());
+
+        size_t kept = 0;
+        for (size_t i = 0; i < rs.size(); ++i) {
+            if (std::binary_search(held.begin(), held.end(), rs[i].ptr))
+                rs[kept++] = rs[i];
+            else
+                rs[i].del(rs[i].ptr);
+        }
+        rs.erase(rs.begin() + kept, rs.end());
+    }
+
+    slot slots[hazard_slots];
+    std::mutex m;
+    vector<retired> orphans;    // retired by threads that have exited, guarded by m
+};
+
+class hazard_pointer {
+public:
+    hazard_pointer()
+        : hp{ hazard_domain::global().acquire() } { }
+
+    hazard_pointer(const hazard_pointer&) = delete;
+    hazard_pointer& operator=(const hazard_pointer&) = delete;
+
+    ~hazard_pointer()
+    {
+        hazard_domain::global().release(hp);
+    }
+
+    template<typename T>
+    T* protect(const std::atomic<T*>& src)
+    // load src and publish it, retrying until src still holds the published value
+    {
+        T* p = src.load(std::memory_order_relaxed);
+        for (;;) {
+            hp->store(p, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            T* q = src.load(std::memory_order_acquire);
+            if (q == p) return p;
+            p = q;
+        }
+    }
+
+    void reset() { hp->store(nullptr, std::memory_order_release); }
+
+private:
+    std::atomic<void*>* hp;   // our slot in the global domain
+};
+
+template<typename T>
+void hazard_retire(T* p)
+// delete p once no hazard pointer holds it
+{
+    hazard_domain::global().retire(p, [](void* q) { delete static_cast<T*>(q); });
+}
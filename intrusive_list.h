@@ -0,0 +1,290 @@
+#pragma once
+
+#include <stdexcept>
+#include <utility>
+
+#include "check.h"
+
+/**
+ * Intrusive circular list: prev/succ disimpan di dalam objek itu sendiri
+ * (list_hook), bukan di node yang dialokasikan. Memasukkan dan mengeluarkan
+ * objek tidak pernah alokasi dan tidak menyalin objeknya. Satu objek bisa
+ * berada di beberapa list sekaligus, satu hook per list, dibedakan dengan tag:
+ *
+ *     struct timer_tag { };
+ *     struct rr_tag { };
+ *     struct session : list_hook<timer_tag>, list_hook<rr_tag> { ... };
+ *
+ *     intrusive_list<session, timer_tag> timers;
+ *     intrusive_list<session, rr_tag> round_robin;
+ *     timers.push_back(s);
+ *     round_robin.push_back(s);
+ *     intrusive_unlink<timer_tag>(s);     // O(1), no list needed
+ *
+ * The list never owns its objects. Like CirList, the links form a ring,
+ * closed by a sentinel hook inside the list object. A hook unlinks itself
+ * when its object is destroyed. Objects can leave a list without the list
+ * knowing, so size() counts the ring.
+ */
+
+struct default_hook_tag { };
+
+template<typename Tag = default_hook_tag>
+struct list_hook {
+    list_hook() = default;
+
+    // copying an object doesn't copy its list memberships
+    list_hook(const list_hook&) { }
+    list_hook& operator=(const list_hook&) { return *this; }
+
+    ~list_hook() { unlink(); }
+
+    bool is_linked() const { return succ != nullptr; }
+
+    void unlink()
+    // leave whatever list this hook is in; no-op when not linked
+    {
+        if (!is_linked()) return;
+        prev->succ = succ;
+        succ->prev = prev;
+        prev = nullptr;
+        succ = nullptr;
+    }
+
+    list_hook* prev = nullptr;     // previous hook
+    list_hook* succ = nullptr;     // successor (next) hook
+};
+
+template<typename Tag, typename T>
+void intrusive_unlink(T& x)
+// take x out of the list it is in through its Tag hook
+{
+    static_cast<list_hook<Tag>&>(x).unlink();
+}
+
+template<typename T, typename Tag = default_hook_tag>
+class intrusive_list {
+public:
+    using hook = list_hook<Tag>;
+
+    intrusive_list()
+    {
+        root.prev = &root;
+        root.succ = &root;
+    }
+
+    intrusive_list(const intrusive_list&) = delete;
+    intrusive_list& operator=(const intrusive_list&) = delete;
+
+    intrusive_list(intrusive_list&& l)
+        : intrusive_list()
+    {
+        take(l);
+    }
+
+    intrusive_list& operator=(intrusive_list&& l)
+    {
+        if (this == &l) return *this;  // assignment to self
+
+        clear();
+        take(l);
+        return *this;
+    }
+
+    ~intrusive_list()
+    {
+        clear();    // the objects outlive us, their hooks mustn't point at root
+        root.prev = nullptr;
+        root.succ = nullptr;
+    }
+
+    class iterator; // member type: iterator
+
+    iterator begin() { return iterator(root.succ, &root); }
+    iterator end() { return iterator(&root, &root); }
+    const iterator begin() const { return iterator(root.succ, &root); }
+    const iterator end() const { return iterator(&root, &root); }
+
+    iterator iterator_to(T& x) { return iterator(&as_hook(x), &root); }  // x must be in this list
+
+    iterator insert(iterator p, T& x); // link x before p
+    iterator erase(iterator p); // unlink *p, returns the elem after it
+
+    void push_back(T& x) { insert(end(), x); }
+    void push_front(T& x) { insert(begin(), x); }
+    void pop_front();
+    void pop_back();
+
+    T& front();
+    T& back();
+    const T& front() const;
+    const T& back() const;
+
+    T& cyclic_next(T& x); // the elem after x, wrapping around to the front
+
+    void clear();   // unlink every elem
+
+    bool empty() const { return root.succ == &root; }
+    int size() const;   // O(n): objects may unlink themselves
+
+private:
+    static hook& as_hook(T& x) { return static_cast<hook&>(x); }
+    static T& as_elem(hook* h) { return static_cast<T&>(*h); }
+
+    void take(intrusive_list& l); // move l's ring into this empty list
+
+    hook root;  // sentinel closing the ring, never an elem
+};
+
+template<typename T, typename Tag>
+class intrusive_list<T, Tag>::iterator {
+public:
+#if HOMEMADE_CHECK_LEVEL > 0
+    iterator(const hook* p, const hook* root)
+        : curr{ const_cast<hook*>(p) }, root{ root } { }
+#else
+    iterator(const hook* p, const hook*)  // unchecked: just the pointer
+        : curr{ const_cast<hook*>(p) } { }
+#endif
+
+    iterator& operator++()  // forward
+    {
+        HOMEMADE_CHECK(curr != root, throw std::out_of_range("increment beyond end()"));
+        curr = curr->succ;
+        return *this;
+    }
+    iterator& operator--() // backward
+    {
+        HOMEMADE_CHECK(curr->prev != root, throw std::out_of_range("decrement beyond begin()"));
+        curr = curr->prev;
+        return *this;
+    }
+    T& operator*() const // get value (dereference)
+    {
+        HOMEMADE_CHECK(curr != root, throw std::out_of_range("dereference beyond range"));
+        return as_elem(curr);
+    }
+    T* operator->() const { return &**this; }
+
+    bool operator==(const iterator& b) const { return curr == b.curr; }
+    bool operator!=(const iterator& b) const { return curr != b.curr; }
+
+    hook* ptr() const { return curr; }
+
+private:
+    hook* curr; // current hook
+#if HOMEMADE_CHECK_LEVEL > 0
+    const hook* root;  // storing root to impose iterator check
+#endif
+};
+
+template<typename T, typename Tag>
+typename intrusive_list<T, Tag>::iterator intrusive_list<T, Tag>::insert(
+    intrusive_list<T, Tag>::iterator p, T& x)
+{
+    hook& h = as_hook(x);
+    if (h.is_linked()) throw std::logic_error("intrusive_list: elem is already in a list");
+
+    hook* s = p.ptr();
+    h.prev = s->prev;
+    h.succ = s;
+    s->prev->succ = &h;
+    s->prev = &h;
+    return iterator(&h, &root);
+}
+
+template<typename T, typename Tag>
+typename intrusive_list<T, Tag>::iterator intrusive_list<T, Tag>::erase(
+    intrusive_list<T, Tag>::iterator p)
+{
+    if (p.ptr() == &root) throw std::out_of_range("attempting to erase end()");
+    hook* s = p.ptr()->succ;
+    p.ptr()->unlink();
+    return iterator(s, &root);
+}
+
+template<typename T, typename Tag>
+void intrusive_list<T, Tag>::pop_front()
+{
+    if (empty()) throw std::runtime_error("empty list");
+    root.succ->unlink();
+}
+
+template<typename T, typename Tag>
+void intrusive_list<T, Tag>::pop_back()
+{
+    if (empty()) throw std::runtime_error("empty list");
+    root.prev->unlink();
+}
+
+template<typename T, typename Tag>
+T& intrusive_list<T, Tag>::front()
+{
+    if (empty()) throw std::runtime_error("empty list");
+    return as_elem(root.succ);
+}
+
+template<typename T, typename Tag>
+T& intrusive_list<T, Tag>::back()
+{
+    if (empty()) throw std::runtime_error("empty list");
+    return as_elem(root.prev);
+}
+
+template<typename T, typename Tag>
+const T& intrusive_list<T, Tag>::front() const
+{
+    if (empty()) throw std::runtime_error("empty list");
+    return as_elem(root.succ);
+}
+
+template<typename T, typename Tag>
+const T& intrusive_list<T, Tag>::back() const
+{
+    if (empty()) throw std::runtime_error("empty list");
+    return as_elem(root.prev);
+}
+
+template<typename T, typename Tag>
+T& intrusive_list<T, Tag>::cyclic_next(T& x)
+// round robin: step over the sentinel, as CirList's iterator does
+{
+    hook* s = as_hook(x).succ;
+    if (s == &root) s = root.succ;
+    return as_elem(s);
+}
+
+template<typename T, typename Tag>
+void intrusive_list<T, Tag>::clear()
+{
+    hook* temp = nullptr; // storing p->succ, because unlink resets it
+    for (hook* p = root.succ; p != &root; p = temp) {
+        temp = p->succ;
+        p->prev = nullptr;
+        p->succ = nullptr;
+    }
+
+    root.prev = &root;
+    root.succ = &root;
+}
+
+template<typename T, typename Tag>
+int intrusive_list<T, Tag>::size() const
+{
+    int n = 0;
+    for (const hook* p = root.succ; p != &root; p = p->succ) ++n;
+    return n;
+}
+
+template<typename T, typename Tag>
+void intrusive_list<T, Tag>::take(intrusive_list<T, Tag>& l)
+{
+    if (l.empty()) return;
+    root.succ = l.root.succ;
+    root.prev = l.root.prev;
+    root.succ->prev = &root;
+    root.prev->succ = &root;
+
+    l.root.prev = &l.root;
+    l.root.succ = &l.root;
+}
@@ -1,27 +1,46 @@
 #pragma once
 
+#include <functional>
 #include <initializer_list>
 #include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <dLink.h>
+#include "check.h"
 
 /**
- * Implementasi linked list dilakukan dengan mengalokasikan 2 uninitialized
- * elemens yang datanya tidak akan diakses, hanya untuk penanda saja
+ * Implementasi linked list memakai 2 sentinel (first dan last) yang datanya
+ * tidak akan diakses, hanya untuk penanda saja. Sentinel disimpan di dalam
+ * objek list sebagai dLink_base, jadi list kosong tidak mengalokasikan apa-apa
+ * dan move tidak pernah alokasi.
+ *
+ * A is rebound to the node type, so any allocator of Elem works, including
+ * std::pmr ones (see pmr::list below):
+ *
+ *     std::pmr::monotonic_buffer_resource arena;
+ *     pmr::list<Request> pending(&arena);     // freed all at once with the arena
  */
 
 //==============================================================================
 
 
-template<typename Elem>
+template<typename Elem, typename A = std::allocator<Elem>>
 class list {
 public:
-    list()
-        : sz{ 0 }, first{ alloc.allocate(1) }, last{ alloc.allocate(1) }
+    using allocator_type = A;
+    using node_allocator = typename std::allocator_traits<A>::template rebind_alloc<dLink<Elem>>;
+    using node_traits = std::allocator_traits<node_allocator>;
+    using link = dLink_base<dLink<Elem>>;  // what the chain is made of; the sentinels are bare links
+
+    list() noexcept(std::is_nothrow_default_constructible<node_allocator>::value)
+    {
+    }
+
+    explicit list(const A& a) noexcept(std::is_nothrow_constructible<node_allocator, const A&>::value)
+        : alloc(a)
     {
-        first->succ = last;
-        first->prev = nullptr;
-        last->prev = first;
-        last->succ = nullptr;
     }
 
     list(std::initializer_list<Elem> lst)
@@ -32,33 +51,27 @@ public:
     }
 
     list(const list& l)
-        : list()
+        : alloc(node_traits::select_on_container_copy_construction(l.alloc))
     {
-        for (const auto& x : l)
-            push_back(x);
+        try {
+            for (const auto& x : l)
+                push_back(x);
+        }
+        catch (...) {
+            clear();    // not delegating, so the destructor won't run
+            throw;
+        }
     }
 
-    list(list&& l)
-        : list()
+    list(list&& l) noexcept
+        : alloc(l.alloc)    // share l's allocator: the nodes we steal came from it
     {
-        // steal representation excluding fl.first and fl.last
-        sz = l.sz;
-        first->succ = l.first->succ;
-        l.first->succ->prev = first;
-        last->prev = l.last->prev;
-        l.last->prev->succ = last;
-
-        // set l's first and last to connect to each other
-        l.first->succ = l.last;
-        l.last->prev = l.first;
-        l.sz = 0;
+        steal(l);
     }
 
     ~list()
     {
         clear();
-        alloc.deallocate(first, 1); // deallocate first
-        alloc.deallocate(last, 1);	// deallocate last
     }
 
     list& operator=(const list& l)
@@ -72,24 +85,26 @@ public:
         return *this;
     }
 
-    list& operator=(list&& l)
+    list& operator=(list&& l) noexcept(node_traits::propagate_on_container_move_assignment::value
+        || node_traits::is_always_equal::value)
     {
         if (this == &l) return *this;  // assignment to self
 
         // clear current content excluding first and last
         clear();
 
-        // steal representation excluding fl.first and fl.last
-        sz = l.sz;
-        first->succ = l.first->succ;
-        l.first->succ->prev = first;
-        last->prev = l.last->prev;
-        l.last->prev->succ = last;
-
-        // set l's first and last to connect to each other
-        l.first->succ = l.last;
-        l.last->prev = l.first;
-        l.sz = 0;
+        // every node must stay with the allocator it came from: take l's
+        // allocator along with its nodes if the allocator allows it (pmr
+        // ones don't), else steal only from an equal allocator
+        if constexpr (node_traits::propagate_on_container_move_assignment::value)
+            std::swap(alloc, l.alloc);
+        else if (alloc != l.alloc) {
+            for (auto p = l.first->succ; p != l.last; p = p->succ)
+                emplace_back(std::move(p->node()->val));
+            l.clear();
+            return *this;
+        }
+        steal(l);
 
         return *this;
     }
@@ -102,10 +117,19 @@ public:
     const iterator end() const { return iterator(last, first, last); }
 
     iterator insert(iterator p, const Elem& v); // insert v into list before p
+    iterator insert(iterator p, Elem&& v);
+    template<typename... Args>
+    iterator emplace(iterator p, Args&&... args); // construct a new elem before p from args
     iterator erase(iterator p); // remove p from the list
 
     void push_back(const Elem& v); // insert v at end
     void push_front(const Elem& v); // insert v at front
+    void push_back(Elem&& v);
+    void push_front(Elem&& v);
+    template<typename... Args>
+    Elem& emplace_back(Args&&... args);
+    template<typename... Args>
+    Elem& emplace_front(Args&&... args);
     void pop_front(); // remove the first element
     void pop_back(); // remove the last element
 
@@ -116,85 +140,135 @@ public:
 
     void clear();       // empty list
 
+    // the operations below only relink nodes; no element is copied or moved
+    void splice(iterator p, list& l); // move all of l before p
+    void splice(iterator p, list& l, iterator it); // move *it from l before p
+    void splice(iterator p, list& l, iterator b, iterator e); // move [b, e) from l before p
+    template<typename Compare = std::less<>>
+    void merge(list& l, Compare comp = Compare{}); // merge sorted l into this sorted list
+    template<typename Compare = std::less<>>
+    void sort(Compare comp = Compare{}); // stable merge sort
+    void reverse();
+    template<typename Pred = std::equal_to<>>
+    void unique(Pred same = Pred{}); // erase consecutive duplicates
+
     int size() const { return sz; }
 
 private:
-    size_t sz;
-    dLink<Elem>* first;	// one elem before range
-    dLink<Elem>* last;	// one elem beyond range
-    std::allocator<dLink<Elem>> alloc;
+    void check_splice(const list& l) const;
+    void link_chain(link* head); // make the nullptr-terminated chain the whole list
+    void steal(list& l) noexcept; // take l's nodes; *this must be empty
+
+    node_allocator alloc;
+    size_t sz = 0;
+    // an empty list: first and last connected to each other
+    link first_base{ nullptr, &last_base };    // storage of first
+    link last_base{ &first_base, nullptr };    // storage of last
+    link* first{ &first_base };	// one elem before range
+    link* last{ &last_base };	// one elem beyond range
 };
 
-template<typename Elem> // requires Element<Elem>() (§19.3.3)
-class list<Elem>::iterator {
+namespace pmr {
+    template<typename Elem>
+    using list = ::list<Elem, std::pmr::polymorphic_allocator<Elem>>;
+}
+
+template<typename Elem, typename A> // requires Element<Elem>() (§19.3.3)
+class list<Elem, A>::iterator {
 public:
-    iterator(dLink<Elem>* p, dLink<Elem>* first, dLink<Elem>* last)
+#if HOMEMADE_CHECK_LEVEL > 0
+    iterator(link* p, link* first, link* last)
         : curr{ p }, first{ first }, last{ last } { }
+#else
+    iterator(link* p, link*, link*)  // unchecked: just the pointer
+        : curr{ p } { }
+#endif
 
     // only overloaded for prefix decrement and increment
     iterator& operator++()  // forward
     {
-        if (curr == last)
-            throw std::out_of_range("increment beyond end()");
+        HOMEMADE_CHECK(curr != last, throw std::out_of_range("increment beyond end()"));
         curr = curr->succ;
         return *this;
     }
     iterator& operator--() // backward
     {
-        if (curr->prev == first)
-            throw std::out_of_range("decrement beyond begin()");
+        HOMEMADE_CHECK(curr->prev != first, throw std::out_of_range("decrement beyond begin()"));
         curr = curr->prev;
         return *this;
     }
     Elem& operator*() // get value (dereference)
     {
-        if (curr == first || curr == last)  // first and last are not to be accessed
-            throw std::out_of_range("dereference beyond range");
-        return curr->val;
+        HOMEMADE_CHECK(curr != first && curr != last,  // first and last are not to be accessed
+            throw std::out_of_range("dereference beyond range"));
+        return curr->node()->val;
     }
     const Elem& operator*() const // get value (dereference)
     {
-        if (curr == first || curr == last)  // first and last are not to be accessed
-            throw std::out_of_range("dereference beyond range");
-        return curr->val;
+        HOMEMADE_CHECK(curr != first && curr != last,  // first and last are not to be accessed
+            throw std::out_of_range("dereference beyond range"));
+        return curr->node()->val;
     }
 
-    dLink<Elem>* operator->() { return curr; }
+    dLink<Elem>* operator->() { return curr->node(); }  // only for an element, not first or last
 
     bool operator==(const iterator& b) const { return curr == b.curr; }
     bool operator!=(const iterator& b) const { return curr != b.curr; }
     explicit operator bool() const { return curr; }
 
-    dLink<Elem>* ptr() const { return curr; }
+    link* ptr() const { return curr; }
 
 private:
-    dLink<Elem>* curr; // current link
+    link* curr; // current link
+#if HOMEMADE_CHECK_LEVEL > 0
     // storing first last to impose iterator check
-    dLink<Elem>* first;
-    dLink<Elem>* last;
+    link* first;
+    link* last;
+#endif
 };
 
-template<typename Elem>
-typename list<Elem>::iterator list<Elem>::insert(list<Elem>::iterator p,
+template<typename Elem, typename A>
+typename list<Elem, A>::iterator list<Elem, A>::insert(list<Elem, A>::iterator p,
     const Elem& v)
+{
+    return emplace(p, v);
+}
+
+template<typename Elem, typename A>
+typename list<Elem, A>::iterator list<Elem, A>::insert(list<Elem, A>::iterator p,
+    Elem&& v)
+{
+    return emplace(p, std::move(v));
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+typename list<Elem, A>::iterator list<Elem, A>::emplace(list<Elem, A>::iterator p,
+    Args&&... args)
 {
     if (p.ptr() == first) throw std::out_of_range("attempting to insert before first");
 
-    std::unique_ptr<dLink<Elem>> newLink{ alloc.allocate(1) };// allocate
-    alloc.construct(newLink.get(), dLink<Elem>(v));			// construct
+    dLink<Elem>* newLink = node_traits::allocate(alloc, 1);   // allocate
+    try {
+        node_traits::construct(alloc, newLink, std::in_place, std::forward<Args>(args)...);  // construct
+    }
+    catch (...) {
+        node_traits::deallocate(alloc, newLink, 1);
+        throw;
+    }
 
     newLink->succ = p.ptr();
-    newLink->prev = p->prev;
-    p->prev->succ = newLink.get();
-    p->prev = newLink.get();
+    newLink->prev = p.ptr()->prev;
+    p.ptr()->prev->succ = newLink;
+    p.ptr()->prev = newLink;
 
     ++sz;
 
-    return iterator(newLink.release(), first, last);
+    return iterator(newLink, first, last);
 }
 
-template<typename Elem>
-typename list<Elem>::iterator list<Elem>::erase(list<Elem>::iterator p)
+template<typename Elem, typename A>
+typename list<Elem, A>::iterator list<Elem, A>::erase(list<Elem, A>::iterator p)
 {
     if (sz == 0) throw std::runtime_error("empty list");   // empty list
     // trying to erase end()
@@ -202,79 +276,106 @@ typename list<Elem>::iterator list<Elem>::erase(list<Elem>::iterator p)
     // trying to erase first
     if (p.ptr() == first) throw std::out_of_range("attempting to erase before begin()");
 
-    p->succ->prev = p->prev;
-    p->prev->succ = p->succ;
+    dLink<Elem>* n = p.ptr()->node();   // p is an element here, not a sentinel
+    n->succ->prev = n->prev;
+    n->prev->succ = n->succ;
 
-    auto it = p->succ;		// iterator to be returned
+    auto it = n->succ;		// iterator to be returned
 
-    alloc.destroy(p.ptr());
-    alloc.deallocate(p.ptr(), 1);
+    node_traits::destroy(alloc, n);
+    node_traits::deallocate(alloc, n, 1);
     --sz;
 
     return iterator(it, first, last);   // return value after p prior to removal
 }
 
-template<typename Elem>
-void list<Elem>::push_back(const Elem& v)
+template<typename Elem, typename A>
+void list<Elem, A>::push_back(const Elem& v)
 {
     insert(end(), v);
 }
 
-template<typename Elem>
-void list<Elem>::push_front(const Elem& v)
+template<typename Elem, typename A>
+void list<Elem, A>::push_front(const Elem& v)
 {
     insert(begin(), v);
 }
 
-template<typename Elem>
-void list<Elem>::pop_back()
+template<typename Elem, typename A>
+void list<Elem, A>::push_back(Elem&& v)
+{
+    insert(end(), std::move(v));
+}
+
+template<typename Elem, typename A>
+void list<Elem, A>::push_front(Elem&& v)
+{
+    insert(begin(), std::move(v));
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+Elem& list<Elem, A>::emplace_back(Args&&... args)
+{
+    return *emplace(end(), std::forward<Args>(args)...);
+}
+
+template<typename Elem, typename A>
+template<typename... Args>
+Elem& list<Elem, A>::emplace_front(Args&&... args)
+{
+    return *emplace(begin(), std::forward<Args>(args)...);
+}
+
+template<typename Elem, typename A>
+void list<Elem, A>::pop_back()
 {
     iterator p{ last->prev, first, last };
     erase(p);
 }
 
-template<typename Elem>
-void list<Elem>::pop_front()
+template<typename Elem, typename A>
+void list<Elem, A>::pop_front()
 {
     erase(begin());
 }
 
-template<typename Elem>
-Elem& list<Elem>::front()
+template<typename Elem, typename A>
+Elem& list<Elem, A>::front()
 {
     if (sz == 0) throw std::runtime_error("empty list");
     return begin()->val;
 }
 
-template<typename Elem>
-Elem& list<Elem>::back()
+template<typename Elem, typename A>
+Elem& list<Elem, A>::back()
 {
     if (sz == 0) throw std::runtime_error("empty list");
-    return end()->prev->val;
+    return last->prev->node()->val;
 }
 
-template<typename Elem>
-const Elem& list<Elem>::front() const
+template<typename Elem, typename A>
+const Elem& list<Elem, A>::front() const
 {
     if (sz == 0) throw std::runtime_error("empty list");
     return begin()->val;
 }
 
-template<typename Elem>
-const Elem& list<Elem>::back() const
+template<typename Elem, typename A>
+const Elem& list<Elem, A>::back() const
 {
     if (sz == 0) throw std::runtime_error("empty list");
-    return end()->prev->val;
+    return last->prev->node()->val;
 }
 
-template<typename Elem>
-void list<Elem>::clear()
+template<typename Elem, typename A>
+void list<Elem, A>::clear()
 {
-    dLink<Elem>* temp = nullptr; // storing p->succ, because after deleted, p->succ causes segfault
-    for (dLink<Elem>* p = begin().ptr(); p != last; p = temp) {
+    link* temp = nullptr; // storing p->succ, because after deleted, p->succ causes segfault
+    for (link* p = first->succ; p != last; p = temp) {
         temp = p->succ;
-        alloc.destroy(p);
-        alloc.deallocate(p, 1);
+        node_traits::destroy(alloc, p->node());
+        node_traits::deallocate(alloc, p->node(), 1);
     }
 
     // link first and last
@@ -283,6 +384,147 @@ void list<Elem>::clear()
     sz = 0;
 }
 
+template<typename Elem, typename A>
+void list<Elem, A>::check_splice(const list<Elem, A>& l) const
+{
+    // nodes must be freed by the allocator that made them
+    if (alloc != l.alloc) throw std::runtime_error("splice between lists with different allocators");
+}
+
+template<typename Elem, typename A>
+void list<Elem, A>::steal(list<Elem, A>& l) noexcept
+{
+    if (l.sz == 0) return;
+
+    // take the chain between l's sentinels and hang it between ours
+    sz = l.sz;
+    first->succ = l.first->succ;
+    first->succ->prev = first;
+    last->prev = l.last->prev;
+    last->prev->succ = last;
+
+    // set l's first and last to connect to each other
+    l.first->succ = l.last;
+    l.last->prev = l.first;
+    l.sz = 0;
+}
+
+template<typename Elem, typename A>
+void list<Elem, A>::link_chain(link* head)
+{
+    link* prev = first;
+    for (link* p = head; p; p = p->succ) {
+        p->prev = prev;
+        prev = p;
+    }
+    prev->succ = last;
+    first->succ = (head ? head : last);
+    last->prev = prev;
+}
+
+template<typename Elem, typename A>
+void list<Elem, A>::splice(list<Elem, A>::iterator p, list<Elem, A>& l)
+{
+    if (this == &l || l.sz == 0) return;
+    splice(p, l, l.begin(), l.end());
+}
+
+template<typename Elem, typename A>
+void list<Elem, A>::splice(list<Elem, A>::iterator p, list<Elem, A>& l,
+    list<Elem, A>::iterator it)
+{
+    if (it == l.end()) throw std::out_of_range("attempting to splice end()");
+    if (p == it) return;
+    iterator next = it;
+    splice(p, l, it, ++next);
+}
+
+template<typename Elem, typename A>
+void list<Elem, A>::splice(list<Elem, A>::iterator p, list<Elem, A>& l,
+    list<Elem, A>::iterator b, list<Elem, A>::iterator e)
+{
+    if (p.ptr() == first) throw std::out_of_range("attempting to splice before first");
+    if (b == e || p == e) return;
+    check_splice(l);
+
+    if (this != &l) {       // only the element count needs a walk
+        size_t n = 0;
+        for (link* q = b.ptr(); q != e.ptr(); q = q->succ) ++n;
+        l.sz -= n;
+        sz += n;
+    }
+
+    link* head = b.ptr();
+    link* tail = e.ptr()->prev;
+
+    // unlink [head, tail] from l
+    head->prev->succ = e.ptr();
+    e.ptr()->prev = head->prev;
+
+    // link it in before p
+    head->prev = p.ptr()->prev;
+    tail->succ = p.ptr();
+    p.ptr()->prev->succ = head;
+    p.ptr()->prev = tail;
+}
+
+template<typename Elem, typename A>
+template<typename Compare>
+void list<Elem, A>::merge(list<Elem, A>& l, Compare comp)
+{
+    if (this == &l || l.sz == 0) return;
+    check_splice(l);
+
+    // detach both chains, merge them, and hang the result between our sentinels
+    last->prev->succ = nullptr;
+    l.last->prev->succ = nullptr;
+    link* a = (sz ? first->succ : nullptr);
+    link_chain(merge_links(a, l.first->succ, comp));
+
+    sz += l.sz;
+    l.first->succ = l.last;
+    l.last->prev = l.first;
+    l.sz = 0;
+}
+
+template<typename Elem, typename A>
+template<typename Compare>
+void list<Elem, A>::sort(Compare comp)
+{
+    if (sz < 2) return;
+    last->prev->succ = nullptr;     // terminate the chain for sort_links
+    link_chain(sort_links(first->succ, comp));
+}
+
+template<typename Elem, typename A>
+void list<Elem, A>::reverse()
+{
+    if (sz < 2) return;
+    link* head = first->succ;
+    link* tail = last->prev;
+    for (link* p = head; p != last; p = p->prev)    // prev is the old succ by now
+        std::swap(p->prev, p->succ);
+
+    tail->prev = first;
+    head->succ = last;
+    first->succ = tail;
+    last->prev = head;
+}
+
+template<typename Elem, typename A>
+template<typename Pred>
+void list<Elem, A>::unique(Pred same)
+{
+    if (sz < 2) return;
+    link* p = first->succ;
+    while (p->succ != last) {
+        if (same(p->node()->val, p->succ->node()->val))
+            erase(iterator(p->succ, first, last));
+        else
+            p = p->succ;
+    }
+}
+
 //==============================================================================
 
 template<typename Iterator>
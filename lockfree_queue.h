@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <utility>
+
+#include "hazard_pointer.h"
+
+/**
+ * Queue lock-free Michael-Scott: banyak producer dan banyak consumer.
+ * head selalu menunjuk node dummy; elemen terdepan ada di node sesudahnya.
+ * Node yang sudah lewat dibebaskan lewat hazard pointer, seperti di
+ * lockfree_stack.
+ *
+ * Producers CAS the succ of the tail node, so unlike sLink the successor
+ * here has to be atomic. The value sits in raw storage because the dummy
+ * node holds none.
+ */
+
+// node of a lockfree_queue
+template<typename Elem>
+struct aLink {
+    std::atomic<aLink*> succ{ nullptr };    // successor (next) node
+    alignas(Elem) unsigned char buf[sizeof(Elem)];  // the value, unless this is the dummy
+
+    Elem* val() { return reinterpret_cast<Elem*>(buf); }
+};
+
+template<typename T>
+class lockfree_queue {
+public:
+    using Node = aLink<T>;
+
+    lockfree_queue()
+    {
+        Node* dummy = new Node;
+        head.store(dummy, std::memory_order_relaxed);
+        tail.store(dummy, std::memory_order_relaxed);
+    }
+
+    lockfree_queue(const lockfree_queue&) = delete;
+    lockfree_queue& operator=(const lockfree_queue&) = delete;
+
+    ~lockfree_queue()
+    {
+        // no other thread may use the queue any more
+        Node* p = head.load(std::memory_order_acquire);
+        Node* temp = p->succ.load(std::memory_order_relaxed);
+        delete p;   // the dummy, no value
+        for (p = temp; p != nullptr; p = temp) {
+            temp = p->succ.load(std::memory_order_relaxed);
+            p->val()->~T();
+            delete p;
+        }
+    }
+
+    void push(const T& val) { emplace(val); }
+    void push(T&& val) { emplace(std::move(val)); }
+
+    template<typename... Args>
+    void emplace(Args&&... args)
+    {
+        Node* n = new Node;
+        try {
+            ::new(static_cast<void*>(n->buf)) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            delete n;
+            throw;
+        }
+
+        hazard_pointer hp;
+        for (;;) {
+            Node* t = hp.protect(tail);
+            Node* next = t->succ.load(std::memory_order_acquire);
+            if (next != nullptr) {  // tail is lagging, help it along
+                tail.compare_exchange_weak(t, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+            if (t->succ.compare_exchange_weak(next, n, std::memory_order_release, std::memory_order_relaxed)) {
+                tail.compare_exchange_strong(t, n, std::memory_order_release, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    bool try_pop(T& out)
+    // move the front element to out; false if the queue was empty
+    {
+        hazard_pointer hh;  // protects the dummy
+        hazard_pointer hn;  // protects the node holding the front element
+        for (;;) {
+            Node* h = hh.protect(head);
+            Node* next = hn.protect(h->succ);
+            if (h != head.load(std::memory_order_acquire)) continue;  // next may already be retired
+            if (next == nullptr) return false;
+
+            Node* t = tail.load(std::memory_order_acquire);
+            if (h == t) {   // tail is lagging behind a push, help it along
+                tail.compare_exchange_weak(t, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+
+            if (head.compare_exchange_weak(h, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                // next is the new dummy; nobody else touches its value
+                T* v = next->val();
+                try {
+                    out = std::move(*v);
+                }
+                catch (...) {
+                    v->~T();
+                    hazard_retire(h);
+                    throw;
+                }
+                v->~T();
+                hh.reset();
+                hazard_retire(h);
+                return true;
+            }
+        }
+    }
+
+    bool empty() const
+    {
+        hazard_pointer hp;
+        return hp.protect(head)->succ.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    // producers and consumers work on different ends, keep them on different lines
+    alignas(cache_line) std::atomic<Node*> head;
+    alignas(cache_line) std::atomic<Node*> tail;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+#include "forward_list.h"
+#include "hazard_pointer.h"
+
+/**
+ * Stack lock-free (Treiber) untuk berbagi item antar thread tanpa mutex.
+ * Node-nya sama dengan forward_list (sLink): succ hanya ditulis sebelum node
+ * dipublikasikan, jadi cukup head yang atomic. Node yang di-pop dibebaskan
+ * lewat hazard pointer, sehingga pop lain yang masih membacanya aman dan
+ * node itu tidak bisa kembali ke head (ABA).
+ *
+ * Nodes come from new/delete: a retired node may be freed by another thread
+ * after the stack itself is gone, so it can't depend on an allocator object.
+ * T must be nothrow move assignable: once a node is unlinked nobody else can
+ * reach it, so a throwing hand-off in try_pop would lose the element.
+ */
+
+template<typename T>
+class lockfree_stack {
+    static_assert(std::is_nothrow_move_assignable<T>::value,
+        "lockfree_stack can't give an element back after a throwing move");
+public:
+    using Node = sLink<T>;
+
+    lockfree_stack() = default;
+
+    lockfree_stack(const lockfree_stack&) = delete;
+    lockfree_stack& operator=(const lockfree_stack&) = delete;
+
+    ~lockfree_stack()
+    {
+        // no other thread may use the stack any more
+        Node* temp = nullptr;
+        for (Node* p = head.load(std::memory_order_acquire); p != nullptr; p = temp) {
+            temp = static_cast<Node*>(p->succ);
+            delete p;
+        }
+    }
+
+    void push(const T& val) { emplace(val); }
+    void push(T&& val) { emplace(std::move(val)); }
+
+    template<typename... Args>
+    void emplace(Args&&... args)
+    {
+        Node* n = new Node(std::in_place, std::forward<Args>(args)...);
+        Node* top = head.load(std::memory_order_relaxed);
+        do n->succ = top;
+        while (!head.compare_exchange_weak(top, n, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    bool try_pop(T& out)
+    // move the top element to out; false if the stack was empty
+    {
+        hazard_pointer hp;
+        Node* n = nullptr;
+        for (;;) {
+            n = hp.protect(head);
+            if (n == nullptr) return false;
+            // n can't be freed while protected, so n->succ is still valid
+            if (head.compare_exchange_weak(n, static_cast<Node*>(n->succ), std::memory_order_acquire, std::memory_order_relaxed))
+                break;
+        }
+
+        out = std::move(n->val);    // can't throw, see the static_assert
+        hp.reset();
+        hazard_retire(n);
+        return true;
+    }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    alignas(cache_line) std::atomic<Node*> head{ nullptr };
+};
@@ -0,0 +1,329 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <utility>
+#include <dLink.h>
+
+/**
+ * Cache dengan batas kapasitas: list dari dLink (urutan pemakaian) ditambah
+ * index hash open addressing yang langsung menunjuk ke node-nya. Satu hit
+ * hanya probe index lalu (mode LRU) memindahkan node ke depan; tidak ada
+ * alokasi dan tidak ada map terpisah.
+ *
+ *     lru_cache<std::string, Page> cache(64 << 20,
+ *         [](const std::string& key, Page& p) { p.flush(); });
+ *     cache.put("a", page, page.bytes());     // weight counts against the budget
+ *     if (Page* p = cache.get("a")) ...
+ *
+ * The capacity is a budget of weights; every entry weighs 1 unless put()
+ * says otherwise, so by default it is a count. In cache_policy::clock mode
+ * a hit only sets a reference bit, and eviction sweeps a hand around the
+ * ring, giving referenced entries a second chance.
+ */
+
+enum class cache_policy {
+    lru,    // evict the least recently used entry; a hit moves the node to the front
+    clock   // evict the first unreferenced entry after the hand; a hit only marks the entry
+};
+
+template<typename K, typename V>
+struct cache_entry {
+    template<typename KK, typename VV>
+    cache_entry(KK&& k, VV&& v, size_t w)
+        : key(std::forward<KK>(k)), val(std::forward<VV>(v)), weight{ w } { }
+
+    K key;
+    V val;
+    size_t weight;
+    bool referenced = false;    // clock mode: hit since the hand last passed
+};
+
+// A is rebound to the node type, as in list, so any allocator of the entries
+// works, including std::pmr ones (see pmr::lru_cache below)
+template<typename K, typename V, cache_policy P = cache_policy::lru,
+    typename Hash = std::hash<K>, typename Eq = std::equal_to<K>,
+    typename A = std::allocator<cache_entry<K, V>>>
+class lru_cache {
+public:
+    using Node = dLink<cache_entry<K, V>>;
+    using link = dLink_base<Node>;
+    using allocator_type = A;
+    using node_allocator = typename std::allocator_traits<A>::template rebind_alloc<Node>;
+    using evict_callback = std::function<void(const K&, V&)>;
+
+    explicit lru_cache(size_t capacity, evict_callback on_evict = nullptr, const A& a = A{})
+        : alloc{ a }, cap{ capacity }, on_evict{ std::move(on_evict) }
+    {
+        rehash(16);
+    }
+
+    lru_cache(const lru_cache&) = delete;
+    lru_cache& operator=(const lru_cache&) = delete;
+
+    ~lru_cache()
+    {
+        clear();
+    }
+
+    V* get(const K& key);   // nullptr on a miss; a hit counts as a use
+    const V* peek(const K& key) const; // look without counting a use
+    bool contains(const K& key) const { return peek(key) != nullptr; }
+
+    template<typename KK, typename VV>
+    V& put(KK&& key, VV&& val, size_t weight = 1); // insert or replace, evicting to stay within capacity
+    bool erase(const K& key);   // drop key without calling the eviction callback
+
+    void clear();   // drop everything, without callbacks
+
+    size_t size() const { return count; }
+    size_t weight() const { return used; }  // sum of the weights of all entries
+    size_t capacity() const { return cap; }
+
+private:
+    struct slot {
+        size_t hash;
+        Node* node;     // nullptr when the slot is empty
+    };
+
+    static constexpr size_t npos = ~size_t{ 0 };
+
+    size_t find(const K& key, size_t h) const; // slot holding key, or npos
+    void index_insert(Node* n, size_t h);
+    void index_erase(size_t i);
+    void rehash(size_t slots);
+
+    void link_front(Node* n);   // lru: most recently used; clock: just behind the hand
+    void unlink(Node* n);
+    void evict_one();
+    void destroy(Node* n);
+
+    using alloc_traits = std::allocator_traits<node_allocator>;
+
+    node_allocator alloc;
+    size_t cap;
+    size_t used = 0;    // total weight
+    size_t count = 0;   // number of entries
+    evict_callback on_evict;
+
+    // an empty ring: the sentinel linked to itself; neither copied nor moved, so this stays valid
+    link root_base{ &root_base, &root_base };   // storage of root
+    link* root{ &root_base };   // sentinel closing the ring; in lru mode root->succ is the most recent
+    link* hand{ root };         // clock mode: next entry to inspect (root when empty)
+
+    std::unique_ptr<slot[]> table;  // open addressing, linear probing
+    size_t mask = 0;                // slots - 1
+};
+
+namespace pmr {
+    template<typename K, typename V, cache_policy P = cache_policy::lru,
+        typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+    using lru_cache = ::lru_cache<K, V, P, Hash, Eq, std::pmr::polymorphic_allocator<cache_entry<K, V>>>;
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+V* lru_cache<K, V, P, Hash, Eq, A>::get(const K& key)
+{
+    size_t i = find(key, Hash{}(key));
+    if (i == npos) return nullptr;
+    Node* n = table[i].node;
+    if constexpr (P == cache_policy::lru) {
+        if (root->succ != n) {   // promote
+            unlink(n);
+            link_front(n);
+        }
+    }
+    else
+        n->val.referenced = true;
+    return &n->val.val;
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+const V* lru_cache<K, V, P, Hash, Eq, A>::peek(const K& key) const
+{
+    size_t i = find(key, Hash{}(key));
+    return i == npos ? nullptr : &table[i].node->val.val;
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+template<typename KK, typename VV>
+V& lru_cache<K, V, P, Hash, Eq, A>::put(KK&& key, VV&& val, size_t weight)
+{
+    if (weight > cap) throw std::invalid_argument("lru_cache: entry heavier than the whole capacity");
+
+    size_t h = Hash{}(key);
+    size_t i = find(key, h);
+    if (i != npos) {    // replace, and count it as a use
+        Node* n = table[i].node;
+        n->val.val = std::forward<VV>(val);
+        used = used - n->val.weight + weight;
+        n->val.weight = weight;
+        if constexpr (P == cache_policy::clock)
+            n->val.referenced = true;
+        // keep n out of the ring while making room, so it can't be its own victim
+        unlink(n);
+        try {
+            while (used > cap) evict_one();
+        }
+        catch (...) {
+            link_front(n);
+            throw;
+        }
+        link_front(n);
+        return n->val.val;
+    }
+
+    // make room first, so the new entry can't be its own victim
+    while (count > 0 && used + weight > cap) evict_one();
+    if (2 * (count + 1) > mask + 1) rehash(2 * (mask + 1));
+
+    Node* n = alloc_traits::allocate(alloc, 1);
+    try {
+        alloc_traits::construct(alloc, n, std::in_place, std::forward<KK>(key), std::forward<VV>(val), weight);
+    }
+    catch (...) {
+        alloc_traits::deallocate(alloc, n, 1);
+        throw;
+    }
+    link_front(n);
+    index_insert(n, h);
+    used += weight;
+    ++count;
+    return n->val.val;
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+bool lru_cache<K, V, P, Hash, Eq, A>::erase(const K& key)
+{
+    size_t i = find(key, Hash{}(key));
+    if (i == npos) return false;
+    Node* n = table[i].node;
+    index_erase(i);
+    unlink(n);
+    destroy(n);
+    return true;
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+void lru_cache<K, V, P, Hash, Eq, A>::clear()
+{
+    link* temp = nullptr; // storing p->succ, because after deleted, p->succ causes segfault
+    for (link* p = root->succ; p != root; p = temp) {
+        temp = p->succ;
+        alloc_traits::destroy(alloc, p->node());
+        alloc_traits::deallocate(alloc, p->node(), 1);
+    }
+    root->prev = root;
+    root->succ = root;
+    hand = root;
+    for (size_t i = 0; i <= mask; ++i) table[i].node = nullptr;
+    used = 0;
+    count = 0;
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+size_t lru_cache<K, V, P, Hash, Eq, A>::find(const K& key, size_t h) const
+{
+    for (size_t i = h & mask; table[i].node; i = (i + 1) & mask)
+        if (table[i].hash == h && Eq{}(table[i].node->val.key, key))
+            return i;
+    return npos;
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+void lru_cache<K, V, P, Hash, Eq, A>::index_insert(Node* n, size_t h)
+{
+    size_t i = h & mask;
+    while (table[i].node) i = (i + 1) & mask;
+    table[i] = slot{ h, n };
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+void lru_cache<K, V, P, Hash, Eq, A>::index_erase(size_t i)
+// backward shift: pull later entries of the probe run into the hole,
+// so lookups never need tombstones
+{
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (!table[j].node) break;
+        size_t home = table[j].hash & mask;
+        // j may move to i only if its home is not in (i, j] (cyclically)
+        bool stays = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+        if (!stays) {
+            table[i] = table[j];
+            i = j;
+        }
+    }
+    table[i].node = nullptr;
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+void lru_cache<K, V, P, Hash, Eq, A>::rehash(size_t slots)
+{
+    std::unique_ptr<slot[]> old = std::move(table);
+    size_t old_slots = old ? mask + 1 : 0;
+
+    table.reset(new slot[slots]);
+    mask = slots - 1;
+    for (size_t i = 0; i < slots; ++i) table[i].node = nullptr;
+    for (size_t i = 0; i < old_slots; ++i)
+        if (old[i].node) index_insert(old[i].node, old[i].hash);
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+void lru_cache<K, V, P, Hash, Eq, A>::link_front(Node* n)
+{
+    link* s = P == cache_policy::lru ? root->succ : hand;  // link n before s
+    n->prev = s->prev;
+    n->succ = s;
+    s->prev->succ = n;
+    s->prev = n;
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+void lru_cache<K, V, P, Hash, Eq, A>::unlink(Node* n)
+{
+    if (n == hand) hand = n->succ;
+    n->prev->succ = n->succ;
+    n->succ->prev = n->prev;
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+void lru_cache<K, V, P, Hash, Eq, A>::evict_one()
+{
+    Node* victim = nullptr;
+    if constexpr (P == cache_policy::lru)
+        victim = root->prev->node();
+    else {
+        for (;;) {  // second chance: clear reference bits until an unreferenced entry comes by
+            if (hand == root) hand = root->succ;
+            if (!hand->node()->val.referenced) break;
+            hand->node()->val.referenced = false;
+            hand = hand->succ;
+        }
+        victim = hand->node();
+    }
+
+    index_erase(find(victim->val.key, Hash{}(victim->val.key)));
+    unlink(victim);
+    try {
+        if (on_evict) on_evict(victim->val.key, victim->val.val);
+    }
+    catch (...) {
+        destroy(victim);
+        throw;
+    }
+    destroy(victim);
+}
+
+template<typename K, typename V, cache_policy P, typename Hash, typename Eq, typename A>
+void lru_cache<K, V, P, Hash, Eq, A>::destroy(Node* n)
+{
+    used -= n->val.weight;
+    --count;
+    alloc_traits::destroy(alloc, n);
+    alloc_traits::deallocate(alloc, n, 1);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * Allocator yang mengambil memori langsung dari kernel dengan mmap.
+ * Ditujukan untuk vector yang sangat besar (ratusan MB ke atas): untuk
+ * tipe yang trivially relocatable, vector::reserve memanggil reallocate()
+ * yang memakai mremap, sehingga pertumbuhan hanya mengubah page table
+ * dan tidak menyalin isi buffer lama.
+ *
+ *     vector<double, mmap_allocator<double, hugepage::advise>> v;
+ *
+ * Every allocation is rounded up to whole pages, so don't use it for
+ * small containers.
+ */
+
+enum class hugepage {
+    none,       // normal pages
+    advise,     // ask for transparent huge pages with madvise(MADV_HUGEPAGE)
+    hugetlb     // map from the hugetlbfs pool (MAP_HUGETLB), falling back to normal pages
+};
+
+template<typename T, hugepage H = hugepage::none>
+class mmap_allocator {
+public:
+    using value_type = T;
+    using size_type = size_t;
+
+    template<typename U>
+    struct rebind { using other = mmap_allocator<U, H>; };
+
+    mmap_allocator() = default;
+    template<typename U>
+    mmap_allocator(const mmap_allocator<U, H>&) { }
+
+    T* allocate(size_type n)
+    {
+        if (n == 0) return nullptr;
+        return static_cast<T*>(map(bytes(n)));
+    }
+
+    void deallocate(T* p, size_type n)
+    {
+        if (p) munmap(p, bytes(n));
+    }
+
+    T* reallocate(T* p, size_type old_n, size_type new_n)
+    // grow or shrink the block, keeping its contents; the mapping may move,
+    // but the pages are only remapped, never copied
+    {
+        if (p == nullptr) return allocate(new_n);
+        if (new_n == 0) {
+            deallocate(p, old_n);
+            return nullptr;
+        }
+        size_type oldbytes = bytes(old_n);
+        size_type newbytes = bytes(new_n);
+        if (oldbytes == newbytes) return p;     // still fits in the same pages
+
+#ifdef MREMAP_MAYMOVE
+        void* q = mremap(p, oldbytes, newbytes, MREMAP_MAYMOVE);
+        if (q == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+        if (H == hugepage::advise && newbytes > oldbytes)
+            madvise(q, newbytes, MADV_HUGEPAGE);
+#endif
+        return static_cast<T*>(q);
+#else
+        // no mremap on this platform: fall back to map + copy
+        void* q = map(newbytes);
+        std::memcpy(q, p, oldbytes < newbytes ? oldbytes : newbytes);
+        munmap(p, oldbytes);
+        return static_cast<T*>(q);
+#endif
+    }
+
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args)
+    {
+        ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    void destroy(U* p)
+    {
+        p->~U();
+    }
+
+    bool operator==(const mmap_allocator&) const { return true; }   // stateless
+    bool operator!=(const mmap_allocator&) const { return false; }
+
+private:
+    static size_type granularity()
+    // mappings are made in whole pages (2MB pages for hugetlb)
+    {
+        static const size_type page = H == hugepage::hugetlb
+            ? size_type{ 2 } << 20
+            : static_cast<size_type>(sysconf(_SC_PAGESIZE));
+        return page;
+    }
+
+    static size_type bytes(size_type n)
+    {
+        size_type g = granularity();
+        return (n * sizeof(T) + g - 1) / g * g;
+    }
+
+    static void* map(size_type len)
+    {
+        void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (H == hugepage::hugetlb)
+            p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (p == MAP_FAILED)    // no hugetlb pool configured: use normal pages
+            p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+        if (H == hugepage::advise)
+            madvise(p, len, MADV_HUGEPAGE);
+#endif
+        return p;
+    }
+};
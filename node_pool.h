@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Slab allocator untuk node linked list (dLink, sLink, Link).
+ * Node diambil dari blok memori yang bersebelahan (slab), node yang di-erase
+ * masuk ke free list dan dipakai lagi oleh insert berikutnya. Semua slab
+ * dibebaskan sekaligus ketika pool dihancurkan, atau lewat release() setelah
+ * semua node dikembalikan:
+ *
+ *     pool_allocator<std::string> a;
+ *     list<std::string, pool_allocator<std::string>> l(a);    // rebound to dLink<std::string>
+ *     ...
+ *     l.clear();
+ *     a.release();     // give the slabs back; a no-op while any node is still out
+ *
+ * A pool_allocator and every copy rebound from it share one set of pools,
+ * one per node size, so two lists built from the same allocator compare
+ * equal and can splice nodes between them.
+ */
+
+class node_pool {
+    // fixed-size slots of one size and alignment, cut from slabs
+public:
+    node_pool(size_t size, size_t align, size_t first_slab = 16, size_t max_slab = 4096)
+        : stride{ slot_stride(size, align) }, align{ slot_align(align) },
+          first_slab{ first_slab }, next_slab{ first_slab }, max_slab{ max_slab } { }
+
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+
+    ~node_pool() { free_slabs(); }
+
+    void* allocate()
+    {
+        slot* s = free_list;
+        if (s)                                  // recycle an erased node
+            free_list = s->next;
+        else {
+            if (used == capacity) grow();
+            s = at(current, used++);
+        }
+        ++live;     // only once the slot is ours, grow() may throw
+        return s;
+    }
+
+    void deallocate(void* p)
+    // the slot goes onto the free list; the slabs stay until release()
+    {
+        slot* s = static_cast<slot*>(p);
+        s->next = free_list;
+        free_list = s;
+        --live;
+    }
+
+    bool release()
+    // free whole slabs if no node is handed out; false (and nothing freed) otherwise
+    {
+        if (live != 0) return false;
+        free_slabs();
+        return true;
+    }
+
+    // the size and alignment of a slot holding a size-byte object
+    static size_t slot_align(size_t align) { return align < alignof(slot) ? alignof(slot) : align; }
+    static size_t slot_stride(size_t size, size_t align)
+    {
+        size_t a = slot_align(align);
+        size_t n = size < sizeof(slot) ? sizeof(slot) : size;
+        return (n + a - 1) / a * a;
+    }
+
+private:
+    struct slot {
+        slot* next;     // link in the free list, or to the previous slab for a slab header
+    };
+
+    slot* at(slot* base, size_t i) const
+    {
+        return reinterpret_cast<slot*>(reinterpret_cast<unsigned char*>(base) + i * stride);
+    }
+
+    void grow()
+    // start a new slab, twice as big as the last one (up to max_slab nodes);
+    // its first slot is the header chaining the slabs together
+    {
+        slot* s = static_cast<slot*>(::operator new(stride * (next_slab + 1), std::align_val_t{ align }));
+        s->next = slabs;
+        slabs = s;
+        current = at(s, 1);
+        capacity = next_slab;
+        used = 0;
+        if (next_slab < max_slab) next_slab *= 2;
+    }
+
+    void free_slabs()
+    // free whole slabs; the nodes in them are not visited
+    {
+        for (slot* s = slabs; s != nullptr; ) {
+            slot* prev = s->next;
+            ::operator delete(s, std::align_val_t{ align });
+            s = prev;
+        }
+        free_list = nullptr;
+        slabs = nullptr;
+        current = nullptr;
+        used = 0;
+        capacity = 0;
+        next_slab = first_slab;
+    }
+
+    size_t stride;              // bytes per slot
+    size_t align;               // alignment of the slots and slabs
+    slot* free_list = nullptr;  // erased nodes, ready for reuse
+    slot* slabs = nullptr;      // most recent slab header
+    slot* current = nullptr;    // nodes of the most recent slab
+    size_t used = 0;            // nodes handed out from current
+    size_t capacity = 0;        // nodes in current
+    size_t live = 0;            // nodes handed out and not yet returned
+    size_t first_slab;
+    size_t next_slab;
+    size_t max_slab;
+};
+
+class node_pools {
+    // the pools shared by a pool_allocator and its rebound copies; node
+    // types of the same slot size and alignment use the same pool
+public:
+    node_pool& get(size_t size, size_t align)
+    {
+        size_t stride = node_pool::slot_stride(size, align);
+        size_t a = node_pool::slot_align(align);
+        for (entry* e = pools.get(); e != nullptr; e = e->next.get())
+            if (e->stride == stride && e->align == a) return e->pool;
+        auto e = std::make_unique<entry>(stride, a);
+        e->next = std::move(pools);
+        pools = std::move(e);
+        return pools->pool;
+    }
+
+    bool release()
+    // free the slabs of every pool without handed-out nodes; true if all were freed
+    {
+        bool all = true;
+        for (entry* e = pools.get(); e != nullptr; e = e->next.get())
+            all = e->pool.release() && all;
+        return all;
+    }
+
+private:
+    struct entry {
+        entry(size_t stride, size_t align)
+            : stride{ stride }, align{ align }, pool(stride, align) { }
+
+        size_t stride;
+        size_t align;
+        node_pool pool;
+        std::unique_ptr<entry> next;
+    };
+
+    std::unique_ptr<entry> pools;   // only a few node sizes, a list is enough
+};
+
+template<typename T>
+class pool_allocator {
+    // Copies, rebound ones included, share one node_pools, so a list that
+    // steals another list's nodes (move, splice) keeps the slabs they live
+    // in alive. Requests for more than one T go to operator new.
+public:
+    using value_type = T;
+
+    template<typename U>
+    struct rebind { using other = pool_allocator<U>; };
+
+    // a moved-to list takes the pool along with the nodes
+    using propagate_on_container_move_assignment = std::true_type;
+
+    pool_allocator()
+        : pools{ std::make_shared<node_pools>() }, pool{ &pools->get(sizeof(T), alignof(T)) } { }
+
+    template<typename U>
+    pool_allocator(const pool_allocator<U>& a)  // same pools, the one for T's size
+        : pools{ a.pools }, pool{ &pools->get(sizeof(T), alignof(T)) } { }
+
+    T* allocate(size_t n)
+    {
+        if (n == 1) return static_cast<T*>(pool->allocate());
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        if (n == 1) pool->deallocate(p);
+        else ::operator delete(p);
+    }
+
+    bool release() { return pools->release(); }   // see node_pools::release
+
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args)
+    {
+        ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    void destroy(U* p)
+    {
+        p->~U();
+    }
+
+    template<typename U>
+    bool operator==(const pool_allocator<U>& a) const { return pools == a.pools; }
+    template<typename U>
+    bool operator!=(const pool_allocator<U>& a) const { return pools != a.pools; }
+
+private:
+    template<typename U>
+    friend class pool_allocator;
+
+    std::shared_ptr<node_pools> pools;
+    node_pool* pool;    // the pool for T, inside pools
+};
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+
+#include "vector.h"
+
+/**
+ * Algoritma paralel untuk vector (dan container lain yang iterator-nya
+ * pointer, mis. small_vector dan persistent_vector), dengan thread pool
+ * sendiri tanpa dependency lain.
+ *
+ * The range is cut into chunks whose boundaries fall on cache line
+ * boundaries, so two threads never write to the same line.
+ */
+
+class thread_pool {
+public:
+    explicit thread_pool(size_t n = std::thread::hardware_concurrency())
+    // n threads take part in run(), counting the calling thread
+    {
+        if (n == 0) n = 1;
+        for (size_t i = 1; i < n; ++i)
+            workers.emplace_back([this] { work(); });
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m };
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    size_t size() const { return workers.size() + 1; }
+
+    template<typename F>
+    void run(size_t tasks, F f)
+    // call f(i) for every i in [0, tasks) and wait until all calls are done;
+    // the calling thread works too, so run() may be nested inside a task
+    {
+        if (tasks == 0) return;
+        if (tasks == 1 || workers.size() == 0) {
+            for (size_t i = 0; i < tasks; ++i) f(i);
+            return;
+        }
+
+        // helpers can start after run() returned, so the job is shared
+        auto job = std::make_shared<batch>();
+        job->tasks = tasks;
+        job->f = std::move(f);
+
+        size_t helpers = std::min(tasks, size()) - 1;
+        {
+            std::lock_guard<std::mutex> lock{ m };
+            for (size_t i = 0; i < helpers; ++i)
+                queue.push([job] { job->drain(); });
+        }
+        if (helpers == 1) cv.notify_one();
+        else cv.notify_all();
+
+        job->drain();
+
+        std::unique_lock<std::mutex> lock{ job->m };
+        job->cv.wait(lock, [&] { return job->done == job->tasks; });
+        if (job->error) std::rethrow_exception(job->error);
+    }
+
+private:
+    struct batch {
+        void drain()
+        // take task indices until there are none left
+        {
+            size_t finished = 0;
+            for (size_t i = next++; i < tasks; i = next++) {
+                try {
+                    f(i);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock{ m };
+                    if (!error) error = std::current_exception();
+                }
+                ++finished;
+            }
+            if (finished == 0) return;
+            std::lock_guard<std::mutex> lock{ m };
+            done += finished;
+            if (done == tasks) cv.notify_all();
+        }
+
+        size_t tasks = 0;
+        std::function<void(size_t)> f;
+        std::atomic<size_t> next{ 0 };
+        size_t done = 0;                // guarded by m
+        std::exception_ptr error;       // first exception thrown by f, guarded by m
+        std::mutex m;
+        std::condition_variable cv;
+    };
+
+    void work()
+    {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock{ m };
+                cv.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (stopping && queue.empty()) return;
+                task = std::move(queue.front());
+                queue.pop();
+            }
+            task();
+        }
+    }
+
+    vector<std::thread> workers;
+    std::queue<std::function<void()>> queue;
+    std::mutex m;
+    std::condition_variable cv;
+    bool stopping = false;
+};
+
+inline thread_pool& default_pool()
+// shared pool with one thread per core, started on first use
+{
+    static thread_pool pool;
+    return pool;
+}
+
+//==============================================================================
+
+template<typename T>
+class chunking {
+public:
+    // split [first, first + n) into about parts chunks of at least min_chunk
+    // elements; when sizeof(T) divides a cache line, every inner boundary is
+    // put on a cache line boundary
+    chunking(T* first, size_t n, size_t parts, size_t min_chunk = 4096)
+        : first{ first }, n{ n }
+    {
+        parts = std::max<size_t>(1, std::min(parts, n / min_chunk));
+        step = std::max<size_t>(1, (n + parts - 1) / parts);
+        if (cache_line % sizeof(T) == 0) {
+            size_t per_line = cache_line / sizeof(T);
+            step = (step + per_line - 1) / per_line * per_line;
+            size_t addr = reinterpret_cast<uintptr_t>(first) % cache_line;
+            if (addr % sizeof(T) == 0)
+                skew = (cache_line - addr) % cache_line / sizeof(T);  // elements before the first line boundary
+        }
+        count = n <= skew + step ? 1 : (n - skew + step - 1) / step;
+    }
+
+    size_t size() const { return count; }
+
+    T* begin(size_t i) const { return first + bound(i); }
+    T* end(size_t i) const { return first + bound(i + 1); }
+
+private:
+    size_t bound(size_t i) const
+    // chunk boundaries: 0, skew + step, skew + 2 * step, ..., n
+    {
+        if (i == 0) return 0;
+        if (i >= count) return n;
+        return skew + i * step;
+    }
+
+    T* first;
+    size_t n;
+    size_t step;
+    size_t skew = 0;
+    size_t count;
+};
+
+template<typename C, typename F>
+void parallel_for_each(C& c, F f, thread_pool& pool = default_pool())
+// f(x) for every element x of c
+{
+    chunking<std::remove_reference_t<decltype(*c.begin())>> ch{ c.begin(), c.size(), 4 * pool.size() };
+    pool.run(ch.size(), [&](size_t i) {
+        for (auto p = ch.begin(i); p != ch.end(i); ++p) f(*p);
+    });
+}
+
+template<typename C, typename T>
+void parallel_fill(C& c, const T& val, thread_pool& pool = default_pool())
+{
+    chunking<std::remove_reference_t<decltype(*c.begin())>> ch{ c.begin(), c.size(), 4 * pool.size() };
+    pool.run(ch.size(), [&](size_t i) {
+        std::fill(ch.begin(i), ch.end(i), val);
+    });
+}
+
+template<typename C1, typename C2, typename F>
+void parallel_transform(const C1& in, C2& out, F f, thread_pool& pool = default_pool())
+// out[i] = f(in[i]); out must already hold at least in.size() elements.
+// Chunks are aligned to out, since that's the side being written
+{
+    if (out.size() < in.size())
+        throw std::out_of_range("parallel_transform: output smaller than input");
+    auto src = in.begin();
+    auto dst = out.begin();
+    chunking<std::remove_reference_t<decltype(*out.begin())>> ch{ dst, in.size(), 4 * pool.size() };
+    pool.run(ch.size(), [&](size_t i) {
+        std::transform(src + (ch.begin(i) - dst), src + (ch.end(i) - dst), ch.begin(i), f);
+    });
+}
+
+template<typename C, typename T, typename Op = std::plus<>>
+T parallel_reduce(const C& c, T init, Op op = Op{}, thread_pool& pool = default_pool())
+// fold c with op, which must be associative; chunks are reduced in parallel
+// and the partial results combined in order
+{
+    using E = std::remove_reference_t<decltype(*c.begin())>;
+    if (c.size() == 0) return init;
+    chunking<E> ch{ c.begin(), c.size(), 4 * pool.size() };
+
+    // one cache line per chunk: workers never write to a shared word, even
+    // for T = bool, where vector<T> would pack the results into bits
+    struct alignas(cache_line) result {
+        T val;
+        bool used;
+    };
+    vector<result> partial;
+    partial.reserve(ch.size());
+    for (size_t i = 0; i < ch.size(); ++i) partial.push_back(result{ init, false });
+    pool.run(ch.size(), [&](size_t i) {
+        auto p = ch.begin(i);
+        if (p == ch.end(i)) return;
+        T acc = *p;
+        for (++p; p != ch.end(i); ++p) acc = op(acc, *p);
+        partial[i].val = std::move(acc);
+        partial[i].used = true;
+    });
+
+    for (size_t i = 0; i < ch.size(); ++i)
+        if (partial[i].used) init = op(init, partial[i].val);
+    return init;
+}
+
+template<typename C, typename Compare = std::less<>>
+void parallel_sort(C& c, Compare comp = Compare{}, thread_pool& pool = default_pool())
+// sort each chunk in parallel, then merge neighbouring runs pairwise,
+// doubling the run length each round
+{
+    using E = std::remove_reference_t<decltype(*c.begin())>;
+    if (c.size() < 2) return;
+    chunking<E> ch{ c.begin(), c.size(), pool.size() };
+    size_t runs = ch.size();
+
+    pool.run(runs, [&](size_t i) { std::sort(ch.begin(i), ch.end(i), comp); });
+
+    for (size_t width = 1; width < runs; width *= 2) {
+        size_t pairs = (runs + 2 * width - 1) / (2 * width);
+        pool.run(pairs, [&](size_t k) {
+            size_t lo = 2 * width * k;
+            size_t mid = lo + width;
+            if (mid >= runs) return;        // odd run out, nothing to merge with
+            size_t hi = std::min(mid + width, runs);
+            std::inplace_merge(ch.begin(lo), ch.begin(mid), ch.end(hi - 1), comp);
+        });
+    }
+}
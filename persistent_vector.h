@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "vector.h"
+
+/**
+ * vector yang isinya disimpan di file yang di-mmap. Membuka file yang sudah
+ * ada langsung memberi vector yang siap dipakai, tanpa parsing atau copy;
+ * halaman baru dibaca dari disk ketika diakses. push_back memperbesar file.
+ *
+ * Only for trivially copyable T, since the bytes in the file are the objects.
+ * The file starts with a persistent_header; the elements follow it.
+ */
+
+// Specialize this to give T a tag that is checked when a file is reopened,
+// so a file written for one record type is not read back as another.
+template<typename T>
+struct persistent_type_tag {
+    static constexpr uint64_t value = 0;
+};
+
+struct persistent_header {
+    char magic[8];          // "HMPVEC" + padding
+    uint32_t version;       // layout version of this header
+    uint32_t elem_size;     // sizeof(T)
+    uint64_t elem_align;    // alignof(T)
+    uint64_t type_tag;      // persistent_type_tag<T>::value
+    uint64_t size;          // number of elements
+    uint64_t capacity;      // number of elements the file has room for
+    char padding[16];       // keep the elements 64 byte aligned
+};
+
+static_assert(sizeof(persistent_header) == 64, "persistent_header layout changed");
+
+template<typename T, typename G = growth_factor_2>
+class persistent_vector {
+    static_assert(std::is_trivially_copyable<T>::value, "persistent_vector needs trivially copyable elements");
+    static_assert(alignof(T) <= sizeof(persistent_header), "over-aligned T");
+public:
+    using size_type = size_t;
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr uint32_t version = 1;
+
+    explicit persistent_vector(const std::string& path)
+    // open path, creating an empty vector file if it doesn't exist
+        : fd{ ::open(path.c_str(), O_RDWR | O_CREAT, 0644) }
+    {
+        if (fd < 0) fail("open " + path);
+
+        try {
+            struct stat st;
+            if (fstat(fd, &st) != 0) fail("stat " + path);
+
+            if (st.st_size == 0) {
+                map(file_bytes(0), true);      // new file: write a fresh header
+                persistent_header* h = hdr();
+                std::memset(h, 0, sizeof(persistent_header));
+                std::memcpy(h->magic, "HMPVEC", 6);
+                h->version = version;
+                h->elem_size = sizeof(T);
+                h->elem_align = alignof(T);
+                h->type_tag = persistent_type_tag<T>::value;
+            }
+            else {
+                if (static_cast<size_t>(st.st_size) < sizeof(persistent_header))
+                    throw std::runtime_error(path + ": truncated persistent_vector file");
+                map(st.st_size, false);
+                check(path, st.st_size);
+            }
+        }
+        catch (...) {
+            close();
+            throw;
+        }
+    }
+
+    persistent_vector(const persistent_vector&) = delete;
+    persistent_vector& operator=(const persistent_vector&) = delete;
+
+    // a moved-from persistent_vector has no file: it reads as empty, and
+    // only assigning to it or destroying it is meaningful
+    persistent_vector(persistent_vector&& a)
+        : fd{ a.fd }, base{ a.base }, mapped{ a.mapped }
+    {
+        a.fd = -1;
+        a.base = nullptr;
+        a.mapped = 0;
+    }
+
+    persistent_vector& operator=(persistent_vector&& a)
+    {
+        if (this == &a) return *this;  // self assignment
+
+        close();
+        fd = a.fd;
+        base = a.base;
+        mapped = a.mapped;
+        a.fd = -1;
+        a.base = nullptr;
+        a.mapped = 0;
+        return *this;
+    }
+
+    ~persistent_vector()
+    {
+        close();
+    }
+
+    iterator begin() { return elem(); }
+    const_iterator begin() const { return elem(); }
+    iterator end() { return elem() + size(); }
+    const_iterator end() const { return elem() + size(); }
+
+    size_type size() const { return base ? hdr()->size : 0; }
+    size_type capacity() const { return base ? hdr()->capacity : 0; }
+
+    T& front() { return *elem(); }
+    T& back() { return elem()[size() - 1]; }
+
+    T& operator[](size_type n) { return elem()[n]; }
+    const T& operator[](size_type n) const { return elem()[n]; }
+
+    T& at(size_type n)
+    {
+        HOMEMADE_CHECK(n < size(), throw std::out_of_range("Size = " + std::to_string(size()) + ", Access = " + std::to_string(n)));
+        return elem()[n];
+    }
+
+    const T& at(size_type n) const
+    {
+        HOMEMADE_CHECK(n < size(), throw std::out_of_range("Size = " + std::to_string(size()) + ", Access = " + std::to_string(n)));
+        return elem()[n];
+    }
+
+    void reserve(size_type newalloc)
+    // extend the file so it holds newalloc elements
+    {
+        if (newalloc <= capacity()) return;    // never decrease allocation
+        size_t bytes = file_bytes(newalloc);
+        if (ftruncate(fd, bytes) != 0) fail("ftruncate");
+        remap(bytes);
+        hdr()->capacity = newalloc;
+    }
+
+    void resize(size_type newsize, T val = T{})
+    {
+        reserve(newsize);
+        for (size_type i = size(); i < newsize; ++i) elem()[i] = val;
+        hdr()->size = newsize;
+    }
+
+    void push_back(const T& val)
+    {
+        if (size() == capacity()) {
+            T v = val;      // val may live in the mapping, which mremap may move
+            reserve(G::next(capacity(), size() + 1, sizeof(T)));
+            elem()[hdr()->size++] = v;
+        }
+        else
+            elem()[hdr()->size++] = val;
+    }
+
+    void pop_back() { --hdr()->size; }
+    void clear() { hdr()->size = 0; }
+
+    void flush()
+    // write dirty pages back to the file now instead of whenever the kernel likes
+    {
+        if (msync(base, mapped, MS_SYNC) != 0) fail("msync");
+    }
+
+private:
+    persistent_header* hdr() { return static_cast<persistent_header*>(base); }
+    const persistent_header* hdr() const { return static_cast<const persistent_header*>(base); }
+    T* elem() { return base ? reinterpret_cast<T*>(static_cast<char*>(base) + sizeof(persistent_header)) : nullptr; }
+    const T* elem() const { return base ? reinterpret_cast<const T*>(static_cast<const char*>(base) + sizeof(persistent_header)) : nullptr; }
+
+    static size_t file_bytes(size_type n) { return sizeof(persistent_header) + n * sizeof(T); }
+
+    [[noreturn]] static void fail(const std::string& what)
+    {
+        throw std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    void map(size_t bytes, bool grow)
+    {
+        if (grow && ftruncate(fd, bytes) != 0) fail("ftruncate");
+        base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            base = nullptr;
+            fail("mmap");
+        }
+        mapped = bytes;
+    }
+
+    void remap(size_t bytes)
+    {
+#ifdef MREMAP_MAYMOVE
+        void* p = mremap(base, mapped, bytes, MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) fail("mremap");
+        base = p;
+        mapped = bytes;
+#else
+        munmap(base, mapped);
+        base = nullptr;
+        map(bytes, false);
+#endif
+    }
+
+    void check(const std::string& path, size_t filesize) const
+    // make sure an existing file was written for this T
+    {
+        const persistent_header* h = hdr();
+        if (std::memcmp(h->magic, "HMPVEC", 6) != 0)
+            throw std::runtime_error(path + ": not a persistent_vector file");
+        if (h->version != version)
+            throw std::runtime_error(path + ": unsupported persistent_vector version " + std::to_string(h->version));
+        if (h->elem_size != sizeof(T) || h->elem_align != alignof(T) || h->type_tag != persistent_type_tag<T>::value)
+            throw std::runtime_error(path + ": element type doesn't match");
+        if (h->size > h->capacity || filesize < file_bytes(h->capacity))
+            throw std::runtime_error(path + ": truncated persistent_vector file");
+    }
+
+    void close()
+    {
+        if (base) munmap(base, mapped);
+        if (fd >= 0) ::close(fd);
+        base = nullptr;
+        mapped = 0;
+        fd = -1;
+    }
+
+    int fd;             // the backing file
+    void* base = nullptr;   // start of the mapping: header, then elements
+    size_t mapped = 0;  // bytes mapped
+};
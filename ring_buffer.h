@@ -0,0 +1,340 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+/**
+ * Ring buffer berkapasitas tetap untuk mengoper elemen antar thread,
+ * pengganti CirList / cforward_list sebagai buffer antar tahap pipeline:
+ * elemen disimpan bersebelahan dalam satu array, tanpa node dan tanpa sentinel.
+ *
+ *     ring_buffer<Job> q(1024);                       // one producer, one consumer
+ *     ring_buffer<Job, ring_mode::mpmc> mq(1024);     // any number of each
+ *
+ * The capacity is rounded up to a power of two, so a position maps to its
+ * slot with a mask. Positions only ever grow; head and tail live on their
+ * own cache lines. All operations are non-blocking and report failure
+ * (full / empty) instead of waiting.
+ */
+
+enum class ring_mode {
+    spsc,   // single producer, single consumer: wait-free
+    mpmc    // multiple producers and consumers: lock-free, bounded
+};
+
+inline size_t ring_capacity(size_t n)
+// smallest power of two >= n (at least 2)
+{
+    size_t c = 2;
+    while (c < n) c *= 2;
+    return c;
+}
+
+template<typename T, ring_mode M = ring_mode::spsc, typename A = std::allocator<T>>
+class ring_buffer;
+
+//==============================================================================
+
+template<typename T, typename A>
+class ring_buffer<T, ring_mode::spsc, A> {
+    // The producer owns tail and the consumer owns head; each keeps a cached
+    // copy of the other's index and only reloads it when the cached value
+    // says the buffer is full (or empty).
+public:
+    explicit ring_buffer(size_t capacity, const A& a = A{})
+        : alloc{ a }, mask{ ring_capacity(capacity) - 1 }, elem{ alloc_traits::allocate(alloc, mask + 1) } { }
+
+    ring_buffer(const ring_buffer&) = delete;
+    ring_buffer& operator=(const ring_buffer&) = delete;
+
+    ~ring_buffer()
+    {
+        for (size_t i = head.load(std::memory_order_relaxed); i != tail.load(std::memory_order_relaxed); ++i)
+            alloc_traits::destroy(alloc, &elem[i & mask]);
+        alloc_traits::deallocate(alloc, elem, mask + 1);
+    }
+
+    size_t capacity() const { return mask + 1; }
+    size_t size() const
+    // exact for the producer and the consumer, a snapshot for anyone else
+    {
+        size_t h = head.load(std::memory_order_acquire);
+        return tail.load(std::memory_order_acquire) - h;
+    }
+    bool empty() const { return size() == 0; }
+
+    // producer side
+    bool try_push(const T& val) { return try_emplace(val); }
+    bool try_push(T&& val) { return try_emplace(std::move(val)); }
+
+    template<typename... Args>
+    bool try_emplace(Args&&... args)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head_cache == capacity()) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t - head_cache == capacity()) return false;    // full
+        }
+        alloc_traits::construct(alloc, &elem[t & mask], std::forward<Args>(args)...);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename Iter>
+    size_t push_n(Iter first, size_t n)
+    // copy up to n elements from first; returns how many fit.
+    // All of them become visible to the consumer at once
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (capacity() - (t - head_cache) < n)
+            head_cache = head.load(std::memory_order_acquire);
+        size_t k = std::min(n, capacity() - (t - head_cache));
+
+        size_t i = 0;
+        try {
+            for (; i < k; ++i, ++first)
+                alloc_traits::construct(alloc, &elem[(t + i) & mask], *first);
+        }
+        catch (...) {
+            tail.store(t + i, std::memory_order_release);  // keep what was built
+            throw;
+        }
+        tail.store(t + k, std::memory_order_release);
+        return k;
+    }
+
+    // consumer side
+    bool try_pop(T& out)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h == tail_cache) return false;     // empty
+        }
+        T& v = elem[h & mask];
+        out = std::move(v);
+        alloc_traits::destroy(alloc, &v);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename Out>
+    size_t pop_n(Out out, size_t n)
+    // move up to n elements to out; returns how many there were
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (tail_cache - h < n)
+            tail_cache = tail.load(std::memory_order_acquire);
+        size_t k = std::min(n, tail_cache - h);
+
+        for (size_t i = 0; i < k; ++i, ++out) {
+            T& v = elem[(h + i) & mask];
+            try {
+                *out = std::move(v);
+            }
+            catch (...) {
+                head.store(h + i, std::memory_order_release);  // v stays in the buffer
+                throw;
+            }
+            alloc_traits::destroy(alloc, &v);
+        }
+        head.store(h + k, std::memory_order_release);
+        return k;
+    }
+
+private:
+    using alloc_traits = std::allocator_traits<A>;
+
+    A alloc;
+    const size_t mask;      // capacity - 1
+    T* const elem;
+
+    alignas(cache_line) std::atomic<size_t> head{ 0 };   // next position to pop
+    size_t tail_cache = 0;                              // consumer's view of tail
+
+    alignas(cache_line) std::atomic<size_t> tail{ 0 };   // next position to push
+    size_t head_cache = 0;                              // producer's view of head
+};
+
+//==============================================================================
+
+template<typename T, typename A>
+class ring_buffer<T, ring_mode::mpmc, A> {
+    // Bounded MPMC queue after Dmitry Vyukov: every slot carries a sequence
+    // number telling which position it is ready for. A slot for position p
+    // is free when seq == p and full when seq == p + 1; popping it sets seq
+    // to p + capacity, the position that reuses it. Producers and consumers
+    // claim positions with a CAS on tail / head.
+    static_assert(std::is_nothrow_move_constructible<T>::value,
+        "ring_buffer<mpmc> needs elements that can be moved without throwing");
+public:
+    explicit ring_buffer(size_t capacity, const A& a = A{})
+        : alloc{ a }, mask{ ring_capacity(capacity) - 1 }, cells{ alloc_traits::allocate(alloc, mask + 1) }
+    {
+        for (size_t i = 0; i <= mask; ++i)
+            ::new(static_cast<void*>(&cells[i])) cell{ i };
+    }
+
+    ring_buffer(const ring_buffer&) = delete;
+    ring_buffer& operator=(const ring_buffer&) = delete;
+
+    ~ring_buffer()
+    {
+        for (size_t i = head.load(std::memory_order_relaxed); i != tail.load(std::memory_order_relaxed); ++i)
+            cells[i & mask].val()->~T();
+        for (size_t i = 0; i <= mask; ++i)
+            cells[i].~cell();
+        alloc_traits::deallocate(alloc, cells, mask + 1);
+    }
+
+    size_t capacity() const { return mask + 1; }
+    size_t size() const
+    // a snapshot; may be stale by the time it returns
+    {
+        size_t h = head.load(std::memory_order_acquire);
+        size_t t = tail.load(std::memory_order_acquire);
+        return t > h ? t - h : 0;
+    }
+    bool empty() const { return size() == 0; }
+
+    bool try_push(const T& val) { return try_emplace(val); }
+    bool try_push(T&& val) { return try_emplace(std::move(val)); }
+
+    template<typename... Args>
+    bool try_emplace(Args&&... args)
+    {
+        if constexpr (!std::is_nothrow_constructible<T, Args&&...>::value) {
+            // a claimed position must be filled before consumers can pass it,
+            // so anything that may throw happens before claiming
+            return try_emplace(T(std::forward<Args>(args)...));
+        }
+        else {
+            size_t pos = claim(tail, 0, 1);
+            if (pos == npos) return false;     // full
+            cell& c = cells[pos & mask];
+            ::new(static_cast<void*>(c.buf)) T(std::forward<Args>(args)...);
+            c.seq.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+    }
+
+    template<typename Iter>
+    size_t push_n(Iter first, size_t n)
+    // claim up to n consecutive free slots with one CAS and fill them from first;
+    // returns how many were pushed. Building an element must not throw,
+    // use std::make_move_iterator for types whose copy may throw
+    {
+        static_assert(std::is_nothrow_constructible<T, decltype(*first)>::value,
+            "ring_buffer<mpmc>::push_n needs elements that are built without throwing");
+        size_t k = 0;
+        size_t pos = claim(tail, 0, n, &k);
+        if (pos == npos) return 0;
+        for (size_t i = 0; i < k; ++i, ++first) {
+            cell& c = cells[(pos + i) & mask];
+            ::new(static_cast<void*>(c.buf)) T(*first);
+            c.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return k;
+    }
+
+    bool try_pop(T& out)
+    {
+        size_t pos = claim(head, 1, 1);
+        if (pos == npos) return false;     // empty
+        cell& c = cells[pos & mask];
+        try {
+            out = std::move(*c.val());
+        }
+        catch (...) {
+            release(c, pos);    // the element is lost, but the slot must go back
+            throw;
+        }
+        release(c, pos);
+        return true;
+    }
+
+    template<typename Out>
+    size_t pop_n(Out out, size_t n)
+    // claim up to n consecutive full slots with one CAS and move them to out;
+    // returns how many were popped. If moving one out throws, the rest of
+    // the batch is dropped so the slots can be reused
+    {
+        size_t k = 0;
+        size_t pos = claim(head, 1, n, &k);
+        if (pos == npos) return 0;
+        size_t i = 0;
+        try {
+            for (; i < k; ++i, ++out) {
+                cell& c = cells[(pos + i) & mask];
+                *out = std::move(*c.val());
+                release(c, pos + i);
+            }
+        }
+        catch (...) {
+            for (; i < k; ++i)
+                release(cells[(pos + i) & mask], pos + i);
+            throw;
+        }
+        return k;
+    }
+
+private:
+    struct cell {
+        std::atomic<size_t> seq;
+        alignas(T) unsigned char buf[sizeof(T)];
+
+        T* val() { return reinterpret_cast<T*>(buf); }
+    };
+    using cell_alloc = typename std::allocator_traits<A>::template rebind_alloc<cell>;
+
+    static constexpr size_t npos = ~size_t{ 0 };
+
+    size_t claim(std::atomic<size_t>& idx, size_t ready, size_t n, size_t* got = nullptr)
+    // take up to n positions from idx (tail for producers, head for consumers)
+    // whose slots have seq == position + ready; returns the first one, or
+    // npos if the slot at idx isn't ready (buffer full / empty)
+    {
+        size_t pos = idx.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t k = 0;
+            for (; k < n; ++k) {
+                size_t seq = cells[(pos + k) & mask].seq.load(std::memory_order_acquire);
+                if (seq != pos + k + ready) break;
+            }
+            if (k == 0) {
+                size_t seq = cells[pos & mask].seq.load(std::memory_order_acquire);
+                if (static_cast<std::intptr_t>(seq - (pos + ready)) < 0) return npos;
+                pos = idx.load(std::memory_order_relaxed);     // someone else took pos, retry
+                continue;
+            }
+            // slots found ready stay ready until their position is claimed, which this CAS does
+            if (idx.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) {
+                if (got) *got = k;
+                return pos;
+            }
+        }
+    }
+
+    void release(cell& c, size_t pos)
+    // destroy the element at pos and hand the slot to the producer of pos + capacity
+    {
+        c.val()->~T();
+        c.seq.store(pos + mask + 1, std::memory_order_release);
+    }
+
+    using alloc_traits = std::allocator_traits<cell_alloc>;
+
+    cell_alloc alloc;
+    const size_t mask;      // capacity - 1
+    cell* const cells;
+
+    alignas(cache_line) std::atomic<size_t> head{ 0 };   // next position to pop
+    alignas(cache_line) std::atomic<size_t> tail{ 0 };   // next position to push
+};
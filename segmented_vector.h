@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "vector.h"
+
+/**
+ * Container untuk backend stack yang tumbuh per segmen (chunk) berukuran
+ * tetap N. Elemen yang sudah ada tidak pernah dipindah atau di-copy saat
+ * tumbuh, jadi push_back tidak punya lonjakan latency seperti vector saat
+ * realokasi, dan tidak alokasi per elemen seperti forward_list.
+ *
+ *     stack<Frame, segmented_vector<Frame>> s;
+ *
+ * A directory (vector of segment pointers) gives O(1) indexing; growing it
+ * copies pointers only. When pop_back empties the top segment, it is kept
+ * as a spare instead of being freed, so a stack going up and down across
+ * a segment boundary doesn't allocate each time.
+ */
+
+template<typename T>
+constexpr size_t segment_default_capacity()
+// about one page per segment, at least 16 elements
+{
+    size_t n = 4096 / sizeof(T);
+    return n < 16 ? 16 : n;
+}
+
+template<typename T, size_t N = segment_default_capacity<T>(), typename A = std::allocator<T>>
+class segmented_vector {
+    static_assert(N > 0, "segmented_vector needs room for at least one element per segment");
+public:
+    using size_type = size_t;
+    using value_type = T;
+
+    class iterator; // member type: iterator
+
+    segmented_vector() { }
+
+    segmented_vector(std::initializer_list<T> lst)
+    {
+        for (const auto& x : lst)
+            push_back(x);
+    }
+
+    segmented_vector(const segmented_vector& a)
+    {
+        for (size_type i = 0; i < a.sz; ++i)
+            push_back(a[i]);
+    }
+
+    segmented_vector& operator=(const segmented_vector& a)
+    {
+        if (this == &a) return *this;  // self assignment
+
+        clear();
+        for (size_type i = 0; i < a.sz; ++i)
+            push_back(a[i]);
+        return *this;
+    }
+
+    segmented_vector(segmented_vector&& a)
+        : alloc{ a.alloc }, dir{ std::move(a.dir) }, sz{ a.sz }, spare{ a.spare }
+    {
+        a.sz = 0;
+        a.spare = nullptr;
+    }
+
+    segmented_vector& operator=(segmented_vector&& a)
+    {
+        if (this == &a) return *this;  // self assignment
+
+        release();
+        alloc = a.alloc;
+        dir = std::move(a.dir);
+        sz = a.sz;
+        spare = a.spare;
+        a.sz = 0;
+        a.spare = nullptr;
+        return *this;
+    }
+
+    ~segmented_vector()
+    {
+        release();
+    }
+
+    iterator begin() { return iterator(dir.begin(), 0); }
+    iterator end() { return iterator(dir.begin(), sz); }
+    const iterator begin() const { return iterator(dir.begin(), 0); }
+    const iterator end() const { return iterator(dir.begin(), sz); }
+
+    size_type size() const { return sz; }
+    bool empty() const { return sz == 0; }
+
+    T& operator[](size_type n) { return dir[n / N][n % N]; }
+    const T& operator[](size_type n) const { return dir[n / N][n % N]; }
+
+    T& at(size_type n)
+    {
+        HOMEMADE_CHECK(n < sz, throw std::out_of_range("Size = " + std::to_string(sz) + ", Access = " + std::to_string(n)));
+        return (*this)[n];
+    }
+
+    const T& at(size_type n) const
+    {
+        HOMEMADE_CHECK(n < sz, throw std::out_of_range("Size = " + std::to_string(sz) + ", Access = " + std::to_string(n)));
+        return (*this)[n];
+    }
+
+    T& front() { return dir[0][0]; }
+    T& back() { return (*this)[sz - 1]; }
+    const T& front() const { return dir[0][0]; }
+    const T& back() const { return (*this)[sz - 1]; }
+
+    void push_back(const T& val) { emplace_back(val); }
+    void push_back(T&& val) { emplace_back(std::move(val)); }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (sz == dir.size() * N) {     // top segment full (or none yet)
+            T* seg = spare ? spare : alloc_traits::allocate(alloc, N);
+            spare = nullptr;
+            try {
+                dir.push_back(seg);
+            }
+            catch (...) {
+                spare = seg;
+                throw;
+            }
+        }
+        T* p = &dir[sz / N][sz % N];
+        alloc_traits::construct(alloc, p, std::forward<Args>(args)...);
+        ++sz;
+        return *p;
+    }
+
+    void pop_back()
+    {
+        if (sz == 0) throw std::runtime_error("empty segmented_vector");
+        --sz;
+        alloc_traits::destroy(alloc, &dir[sz / N][sz % N]);
+        if (sz % N == 0) {      // top segment is empty now, keep it as the spare
+            if (spare) alloc_traits::deallocate(alloc, spare, N);
+            spare = dir[dir.size() - 1];
+            dir.erase(dir.end() - 1);
+        }
+    }
+
+    void clear()
+    // destroy every element; one segment is kept as the spare
+    {
+        while (sz > 0) pop_back();
+    }
+
+private:
+    void release()
+    // destroy every element and free every segment
+    {
+        for (size_type i = 0; i < sz; ++i)
+            alloc_traits::destroy(alloc, &(*this)[i]);
+        for (T* seg : dir)
+            alloc_traits::deallocate(alloc, seg, N);
+        if (spare) alloc_traits::deallocate(alloc, spare, N);
+        dir.erase(dir.begin(), dir.end());
+        sz = 0;
+        spare = nullptr;
+    }
+
+    using alloc_traits = std::allocator_traits<A>;
+
+    A alloc;            // use allocate to handle memory for segments
+    vector<T*> dir;     // segments in use, bottom first
+    size_type sz = 0;   // number of elements
+    T* spare = nullptr; // emptied segment kept for the next push_back
+};
+
+template<typename T, size_t N, typename A>
+class segmented_vector<T, N, A>::iterator {
+public:
+    iterator(T* const* dir, size_t i)
+        : dir{ dir }, idx{ i } { }
+
+    iterator& operator++() { ++idx; return *this; }  // forward
+    iterator& operator--() { --idx; return *this; }  // backward
+
+    T& operator*() const { return dir[idx / N][idx % N]; }  // get value (dereference)
+    T* operator->() const { return &**this; }
+
+    bool operator==(const iterator& b) const { return idx == b.idx; }
+    bool operator!=(const iterator& b) const { return idx != b.idx; }
+
+private:
+    T* const* dir;  // the segment directory
+    size_t idx;     // position in the container
+};
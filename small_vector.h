@@ -0,0 +1,299 @@
+#pragma once
+
+#include "vector.h"
+ // homebrew small_vector
+
+/**
+ * vector dengan N elemen pertama disimpan di dalam objeknya sendiri (inline).
+ * Memori heap baru dialokasikan ketika jumlah elemen melebihi N.
+ * Interface-nya sama dengan vector, termasuk growth policy G untuk heap.
+ */
+
+template<typename T, size_t N, typename A = std::allocator<T>, typename G = growth_factor_2>
+class small_vector {
+    static_assert(N > 0, "small_vector needs room for at least one inline element");
+public:
+    using size_type = size_t;
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() { return elem; };
+    const_iterator begin() const { return elem; };
+    iterator end() { return elem + sz; };
+    const_iterator end() const { return elem + sz; };
+
+    size_type size() const { return sz; };
+
+    T& front() { return *elem; }
+    T& back() { return *(elem + sz - 1); }
+
+    small_vector()
+        : sz{ 0 }, elem{ inline_elem() }, space{ N }
+    {
+    }
+
+    small_vector(size_type s, T val)
+        : small_vector()
+    {
+        reserve(s);
+        size_type i = 0;
+        try {
+            for (; i < s; ++i)
+                alloc_traits::construct(alloc, &elem[i], val);      // initialize elements
+        }
+        catch (...) {
+            for (size_type j = 0; j < i; ++j)
+                alloc_traits::destroy(alloc, &elem[j]);     // destroy the ones already built
+            throw;
+        }
+        sz = s;
+    }
+
+    small_vector(std::initializer_list<T> lst)
+        : small_vector()
+    {
+        reserve(lst.size());
+        for (const auto& x : lst) {
+            alloc_traits::construct(alloc, &elem[sz], x);
+            ++sz;       // only count it once built, so the destructor cleans up after a throw
+        }
+    }
+
+    small_vector(const small_vector& arg)
+        : small_vector()
+    {
+        reserve(arg.sz);
+        for (const auto& x : arg) {
+            alloc_traits::construct(alloc, &elem[sz], x);
+            ++sz;
+        }
+    }
+
+    small_vector& operator=(const small_vector& a)
+    {
+        if (this == &a) return *this;       // self_assignment, no work needed
+
+        clear();
+        reserve(a.sz);
+        for (const auto& x : a) {
+            alloc_traits::construct(alloc, &elem[sz], x);
+            ++sz;
+        }
+        return *this;
+    }
+
+    small_vector(small_vector&& a)
+        : small_vector()
+    {
+        steal(a);
+    }
+
+    small_vector& operator=(small_vector&& a)
+    {
+        if (this == &a) return *this;  // self assignment
+
+        clear();
+        release();
+        steal(a);
+        return *this;
+    }
+
+    ~small_vector()
+    {
+        clear();
+        release();
+    }
+
+    T& operator[](size_type n)
+    {
+        return elem[n];
+    }
+
+    const T& operator[](size_type n) const
+    {
+        return elem[n];
+    }
+
+    T& at(size_type n)
+    {
+        HOMEMADE_CHECK(n < sz, throw std::out_of_range("Size = " + std::to_string(sz) + ", Access = " + std::to_string(n)));
+        return elem[n];
+    }
+
+    const T& at(size_type n) const
+    {
+        HOMEMADE_CHECK(n < sz, throw std::out_of_range("Size = " + std::to_string(sz) + ", Access = " + std::to_string(n)));
+        return elem[n];
+    }
+
+    size_type capacity() const
+    {
+        return space;
+    }
+
+    bool is_inline() const
+    // true while the elements still live inside the object
+    {
+        return elem == inline_elem();
+    }
+
+    void reserve(size_type newalloc)
+    {
+        if (newalloc <= space) return;      // never decrease allocation
+        T* p = alloc_traits::allocate(alloc, newalloc);    // spill to the heap
+        try {
+            uninitialized_relocate(alloc, elem, sz, p);
+        }
+        catch (...) {
+            alloc_traits::deallocate(alloc, p, newalloc);
+            throw;
+        }
+        release();                          // deallocate old space, unless it is inline
+        elem = p;
+        space = newalloc;
+    }
+
+    void resize(size_type newsize, T val)
+    // make the small_vector have newsize elements
+    // intitialize each new element with the default value
+    {
+        reserve(newsize);
+        for (; sz < newsize; ++sz) alloc_traits::construct(alloc, &elem[sz], val);             // construct
+        for (size_type i = newsize; i < sz; ++i) alloc_traits::destroy(alloc, &elem[i]);         // destroy
+        sz = newsize;
+    }
+
+    void clear()
+    {
+        for (size_type i = 0; i < sz; ++i)
+            alloc_traits::destroy(alloc, &elem[i]);
+        sz = 0;
+    }
+
+    void push_back(const T& val)
+    {
+        emplace_back(val);
+    }
+
+    void push_back(T&& val)
+    {
+        emplace_back(std::move(val));
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    {
+        if (sz == space) {
+            // as in vector: build the new element first, args may refer into *this
+            size_type newalloc = next_capacity(sz + 1);
+            T* p = alloc_traits::allocate(alloc, newalloc);
+            try {
+                alloc_traits::construct(alloc, &p[sz], std::forward<Args>(args)...);
+            }
+            catch (...) {
+                alloc_traits::deallocate(alloc, p, newalloc);
+                throw;
+            }
+            try {
+                uninitialized_relocate(alloc, elem, sz, p);
+            }
+            catch (...) {
+                alloc_traits::destroy(alloc, &p[sz]);
+                alloc_traits::deallocate(alloc, p, newalloc);
+                throw;
+            }
+            release();
+            elem = p;
+            space = newalloc;
+        }
+        else
+            alloc_traits::construct(alloc, &elem[sz], std::forward<Args>(args)...);
+        return elem[sz++];
+    }
+
+    iterator erase(iterator p)
+    {
+        if (p == end()) return p;
+        std::move(p + 1, end(), p);     // move elements "one position to the left"
+        alloc_traits::destroy(alloc, end() - 1);       // destroy surplus last element
+        --sz;
+        return p;
+    }
+
+    iterator insert(iterator p, const T& val)
+    {
+        return emplace(p, val);
+    }
+
+    iterator insert(iterator p, T&& val)
+    {
+        return emplace(p, std::move(val));
+    }
+
+    template<typename... Args>
+    iterator emplace(iterator p, Args&&... args)
+    {
+        size_type index = p - begin();
+        if (index == sz) {
+            emplace_back(std::forward<Args>(args)...);
+            return begin() + index;
+        }
+
+        T val(std::forward<Args>(args)...);
+        if (sz == space)
+            reserve(next_capacity(sz + 1));
+
+        alloc_traits::construct(alloc, elem + sz, std::move(back()));
+
+        ++sz;
+        iterator pp = begin() + index;
+        std::move_backward(pp, end() - 2, end() - 1);
+        *pp = std::move(val);
+        return pp;
+    }
+
+private:
+    T* inline_elem() { return reinterpret_cast<T*>(buf); }
+    const T* inline_elem() const { return reinterpret_cast<const T*>(buf); }
+
+    size_type next_capacity(size_type needed) const
+    // the allocation to grow to when we need room for needed elements
+    {
+        return G::next(space, needed, sizeof(T));
+    }
+
+    void release()
+    // give heap space back to alloc and fall back to the inline buffer
+    {
+        if (!is_inline())
+            alloc_traits::deallocate(alloc, elem, space);
+        elem = inline_elem();
+        space = N;
+    }
+
+    void steal(small_vector& a)
+    // take a's elements; *this must be empty and inline
+    {
+        if (a.is_inline()) {
+            uninitialized_relocate(alloc, a.elem, a.sz, elem);   // inline storage can't be stolen
+            sz = a.sz;
+        }
+        else {
+            elem = a.elem;
+            sz = a.sz;
+            space = a.space;
+            a.elem = a.inline_elem();
+            a.space = N;
+        }
+        a.sz = 0;
+    }
+
+    using alloc_traits = std::allocator_traits<A>;
+
+    A alloc;            // use allocate to handle memory for spilled elements
+    size_type sz;       // the size
+    value_type* elem;   // points at buf, or at heap memory after spilling
+    size_type space;    // N while inline, the heap allocation afterwards
+    alignas(T) unsigned char buf[N * sizeof(T)];   // inline storage for the first N elements
+};
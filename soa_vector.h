@@ -0,0 +1,204 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "vector.h"
+
+/**
+ * Structure of arrays: setiap field disimpan dalam vector-nya sendiri
+ * (satu kolom), dengan satu size dan satu capacity untuk semua kolom.
+ * Scan satu field hanya membaca kolom itu saja, bukan seluruh struct:
+ *
+ *     soa_vector<int, double, char> trades;   // id, price, side
+ *     trades.push_back(1, 99.5, 'b');
+ *     double sum = 0;
+ *     for (double p : trades.column<1>())     // contiguous doubles only
+ *         sum += p;
+ *     for (auto [id, price, side] : trades)   // tuple of references
+ *         ...
+ *
+ * Every column is grown to the same capacity before an element is added,
+ * so push_back never reallocates halfway through a row.
+ */
+
+template<typename T>
+class column_span {
+    // a view of one column: a pointer and a length, like std::span
+public:
+    column_span(T* p, size_t n)
+        : ptr{ p }, n{ n } { }
+
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + n; }
+    T* data() const { return ptr; }
+    size_t size() const { return n; }
+    T& operator[](size_t i) const { return ptr[i]; }
+
+private:
+    T* ptr;
+    size_t n;
+};
+
+template<typename... Ts>
+class soa_vector {
+    static_assert(sizeof...(Ts) > 0, "soa_vector needs at least one column");
+    static_assert((!std::is_same<Ts, bool>::value && ...),
+        "vector<bool> is bit-packed and has no spans; use char for a flag column");
+public:
+    using size_type = size_t;
+    using value_type = std::tuple<Ts...>;
+    using reference = std::tuple<Ts&...>;
+    using const_reference = std::tuple<const Ts&...>;
+
+    template<size_t I>
+    using column_type = std::tuple_element_t<I, value_type>;
+
+    class iterator;         // member type: iterator
+    class const_iterator;   // member type: iterator over a const soa_vector
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    size_type size() const { return std::get<0>(cols).size(); }
+    bool empty() const { return size() == 0; }
+    size_type capacity() const { return std::get<0>(cols).capacity(); }
+
+    template<size_t I>
+    column_span<column_type<I>> column() { return { std::get<I>(cols).begin(), size() }; }
+    template<size_t I>
+    column_span<const column_type<I>> column() const { return { std::get<I>(cols).begin(), size() }; }
+
+    reference operator[](size_type n) { return row(n, indices{}); }
+    const_reference operator[](size_type n) const { return row(n, indices{}); }
+
+    reference at(size_type n)
+    {
+        HOMEMADE_CHECK(n < size(), throw std::out_of_range("Size = " + std::to_string(size()) + ", Access = " + std::to_string(n)));
+        return (*this)[n];
+    }
+
+    const_reference at(size_type n) const
+    {
+        HOMEMADE_CHECK(n < size(), throw std::out_of_range("Size = " + std::to_string(size()) + ", Access = " + std::to_string(n)));
+        return (*this)[n];
+    }
+
+    void reserve(size_type newalloc) { reserve(newalloc, indices{}); }
+
+    void push_back(const Ts&... vals) { emplace_back(vals...); }
+    void push_back(Ts&&... vals) { emplace_back(std::move(vals)...); }
+    void push_back(const value_type& row) { std::apply([this](const Ts&... vals) { emplace_back(vals...); }, row); }
+
+    template<typename... Args>
+    void emplace_back(Args&&... args)
+    // one argument per column; if building a field throws, the fields
+    // already added to the other columns are removed again
+    {
+        static_assert(sizeof...(Args) == sizeof...(Ts), "soa_vector::emplace_back takes one value per column");
+        if (size() == capacity()) {
+            value_type row(std::forward<Args>(args)...);    // args may refer into the columns about to move
+            reserve(growth_factor_2::next(capacity(), size() + 1, 0));
+            std::apply([this](Ts&... vals) { emplace_row(indices{}, std::move(vals)...); }, row);
+        }
+        else
+            emplace_row(indices{}, std::forward<Args>(args)...);
+    }
+
+    void pop_back() { pop_back(indices{}); }
+
+    void erase(size_type n) { erase(n, n + 1); }
+    void erase(size_type first, size_type last) { erase(first, last, indices{}); } // remove rows [first, last)
+    void clear() { erase(0, size()); }
+
+private:
+    using indices = std::index_sequence_for<Ts...>;
+
+    template<size_t... Is>
+    reference row(size_type n, std::index_sequence<Is...>) { return reference(std::get<Is>(cols)[n]...); }
+    template<size_t... Is>
+    const_reference row(size_type n, std::index_sequence<Is...>) const { return const_reference(std::get<Is>(cols)[n]...); }
+
+    template<size_t... Is>
+    void reserve(size_type newalloc, std::index_sequence<Is...>)
+    {
+        // column 0 last: capacity() only grows once every column has room
+        (std::get<sizeof...(Is) - 1 - Is>(cols).reserve(newalloc), ...);
+    }
+
+    template<size_t... Is, typename... Args>
+    void emplace_row(std::index_sequence<Is...>, Args&&... args)
+    {
+        size_type done = 0;     // columns holding the new field
+        try {
+            ((std::get<Is>(cols).emplace_back(std::forward<Args>(args)), ++done), ...);
+        }
+        catch (...) {
+            ((Is < done ? std::get<Is>(cols).pop_back() : void()), ...);
+            throw;
+        }
+    }
+
+    template<size_t... Is>
+    void pop_back(std::index_sequence<Is...>) { (std::get<Is>(cols).pop_back(), ...); }
+
+    template<size_t... Is>
+    void erase(size_type first, size_type last, std::index_sequence<Is...>)
+    {
+        (std::get<Is>(cols).erase(std::get<Is>(cols).begin() + first, std::get<Is>(cols).begin() + last), ...);
+    }
+
+    std::tuple<vector<Ts>...> cols;     // one vector per field, all of the same size
+};
+
+template<typename... Ts>
+class soa_vector<Ts...>::iterator {
+public:
+    iterator(soa_vector* v, size_t i)
+        : v{ v }, idx{ i } { }
+
+    iterator& operator++() { ++idx; return *this; }  // forward
+    iterator& operator--() { --idx; return *this; }  // backward
+
+    reference operator*() const { return (*v)[idx]; }   // the fields of one row, by reference
+
+    bool operator==(const iterator& b) const { return idx == b.idx; }
+    bool operator!=(const iterator& b) const { return idx != b.idx; }
+
+    size_t index() const { return idx; }
+
+private:
+    friend class const_iterator;
+
+    soa_vector* v;  // the container
+    size_t idx;     // row
+};
+
+template<typename... Ts>
+class soa_vector<Ts...>::const_iterator {
+public:
+    const_iterator(const soa_vector* v, size_t i)
+        : v{ v }, idx{ i } { }
+
+    const_iterator(const iterator& it)
+        : v{ it.v }, idx{ it.idx } { }
+
+    const_iterator& operator++() { ++idx; return *this; }  // forward
+    const_iterator& operator--() { --idx; return *this; }  // backward
+
+    const_reference operator*() const { return (*v)[idx]; }   // the fields of one row, by const reference
+
+    bool operator==(const const_iterator& b) const { return idx == b.idx; }
+    bool operator!=(const const_iterator& b) const { return idx != b.idx; }
+
+    size_t index() const { return idx; }
+
+private:
+    const soa_vector* v;    // the container
+    size_t idx;             // row
+};
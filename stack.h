@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include <type_traits>
+
 #include "list.h"
 #include "forward_list.h"
 #include "vector.h"
@@ -12,6 +15,8 @@ public:
     // constructor
     stack(std::initializer_list<T> lst) : con(lst) { }
     stack() : con() { }
+    template<typename Alloc, typename = std::enable_if_t<std::uses_allocator<Container, Alloc>::value>>
+    explicit stack(const Alloc& a) : con(a) { }    // e.g. a std::pmr allocator for a list-backed stack
     stack(const stack& s) : con(s.con) { }
     stack(stack&& s) : con(std::move(s.con)) { }
 
@@ -27,20 +32,20 @@ public:
         return *this;
     }
 
-    T& top() { return con.back(); }
-    const T& top() const { return con.back(); }
+    decltype(auto) top() { return con.back(); }  // a proxy for vector<bool>
+    decltype(auto) top() const { return con.back(); }
 
-    bool empty() const { return con.size(); }
+    bool empty() const { return con.size() == 0; }
     size_t size() const { return con.size(); }
 
     void push(const T& val) { con.push_back(val); }
     void pop() { con.pop_back(); }
 
     // Untuk traversal
-    typename Container::iterator& begin() { return con.begin(); }
-    typename Container::iterator& end() { return con.end(); }
-    const typename Container::iterator& begin() const { return con.begin(); }
-    const typename Container::iterator& end() const { return con.end(); }
+    auto begin() { return con.begin(); }
+    auto end() { return con.end(); }
+    auto begin() const { return con.begin(); }
+    auto end() const { return con.end(); }
 private:
     Container con;
 };
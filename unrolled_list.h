@@ -0,0 +1,399 @@
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "check.h"
+
+/**
+ * Unrolled linked list: seperti list, tetapi setiap node menyimpan sampai N
+ * elemen dalam array. Traversal hanya mengikuti satu pointer succ per N elemen,
+ * sehingga scan jauh lebih ramah cache.
+ *
+ * Like list, the range is bracketed by two uninitialized sentinel nodes.
+ * A full node is split in half on insert, and a node that drops below a
+ * quarter full is merged with its successor on erase.
+ */
+
+template<typename Elem>
+constexpr size_t unrolled_default_capacity()
+// as many elements as fit in about 4 cache lines next to the links
+{
+    size_t n = (256 - 3 * sizeof(void*)) / sizeof(Elem);
+    return n < 4 ? 4 : n;
+}
+
+// node of an unrolled list
+template<typename Elem, size_t N>
+struct uLink {
+    uLink* prev;     // previous node
+    uLink* succ;     // successor (next) node
+    size_t count;    // number of constructed elements in val
+    alignas(Elem) unsigned char buf[N * sizeof(Elem)];
+
+    Elem* val() { return reinterpret_cast<Elem*>(buf); }
+};
+
+// A is rebound to the node type, so any allocator of Elem works, including
+// std::pmr ones (see pmr::unrolled_list below)
+template<typename Elem, size_t N = unrolled_default_capacity<Elem>(),
+    typename A = std::allocator<Elem>>
+class unrolled_list {
+    static_assert(N >= 2, "unrolled_list nodes need room for at least 2 elements");
+public:
+    using Node = uLink<Elem, N>;
+    using allocator_type = A;
+    using node_allocator = typename std::allocator_traits<A>::template rebind_alloc<Node>;
+    using node_traits = std::allocator_traits<node_allocator>;
+
+    unrolled_list()
+        : unrolled_list(A{})
+    {
+    }
+
+    explicit unrolled_list(const A& a)
+        : alloc(a), sz{ 0 }, first{ node_traits::allocate(alloc, 1) }, last{ node_traits::allocate(alloc, 1) }
+    {
+        first->succ = last;
+        first->prev = nullptr;
+        first->count = 0;
+        last->prev = first;
+        last->succ = nullptr;
+        last->count = 0;
+    }
+
+    unrolled_list(std::initializer_list<Elem> lst)
+        : unrolled_list()	// delegate to default ctor
+    {
+        for (const auto& x : lst)
+            push_back(x);
+    }
+
+    unrolled_list(const unrolled_list& l)
+        : unrolled_list(A(node_traits::select_on_container_copy_construction(l.alloc)))
+    {
+        for (const auto& x : l)
+            push_back(x);
+    }
+
+    unrolled_list(unrolled_list&& l)
+        : unrolled_list(A(l.alloc))     // same allocator, so the nodes can change hands
+    {
+        swap_nodes(l);
+    }
+
+    ~unrolled_list()
+    {
+        clear();
+        node_traits::deallocate(alloc, first, 1); // deallocate first
+        node_traits::deallocate(alloc, last, 1);	// deallocate last
+    }
+
+    unrolled_list& operator=(const unrolled_list& l)
+    {
+        if (this == &l) return *this;  // assignment to self
+
+        clear();
+        for (const auto& x : l)
+            push_back(x);
+
+        return *this;
+    }
+
+    unrolled_list& operator=(unrolled_list&& l)
+    {
+        if (this == &l) return *this;  // assignment to self
+
+        clear();
+        // every node must stay with the allocator it came from, as in list
+        if constexpr (node_traits::propagate_on_container_move_assignment::value)
+            std::swap(alloc, l.alloc);
+        else if (alloc != l.alloc) {
+            for (auto& x : l)
+                push_back(std::move(x));
+            l.clear();
+            return *this;
+        }
+        swap_nodes(l);
+        return *this;
+    }
+
+    void swap(unrolled_list& l)
+    // the allocators must be equal unless they propagate on swap
+    {
+        if constexpr (node_traits::propagate_on_container_swap::value)
+            std::swap(alloc, l.alloc);
+        swap_nodes(l);
+    }
+
+    class iterator; // member type: iterator
+
+    iterator begin() { return iterator(first->succ, 0, first, last); }
+    iterator end() { return iterator(last, 0, first, last); }
+    const iterator begin() const { return iterator(first->succ, 0, first, last); }
+    const iterator end() const { return iterator(last, 0, first, last); }
+
+    iterator insert(iterator p, const Elem& v); // insert v before p
+    iterator erase(iterator p); // remove p from the list
+
+    void push_back(const Elem& v) { insert(end(), v); }
+    void push_front(const Elem& v) { insert(begin(), v); }
+    void pop_front() { erase(begin()); }
+    void pop_back();
+
+    Elem& front();
+    Elem& back();
+    const Elem& front() const;
+    const Elem& back() const;
+
+    void clear();       // empty list
+
+    int size() const { return sz; }
+
+private:
+    Node* new_node_after(Node* n);
+    void free_node(Node* n);
+    void swap_nodes(unrolled_list& l) noexcept; // trade nodes with l; the allocators must be equal
+
+    node_allocator alloc;
+    size_t sz;
+    Node* first;	// one node before range
+    Node* last;	    // one node beyond range
+};
+
+namespace pmr {
+    template<typename Elem, size_t N = unrolled_default_capacity<Elem>()>
+    using unrolled_list = ::unrolled_list<Elem, N, std::pmr::polymorphic_allocator<Elem>>;
+}
+
+template<typename Elem, size_t N, typename A>
+class unrolled_list<Elem, N, A>::iterator {
+public:
+#if HOMEMADE_CHECK_LEVEL > 0
+    iterator(Node* p, size_t i, Node* first, Node* last)
+        : curr{ p }, idx{ i }, first{ first }, last{ last } { }
+#else
+    iterator(Node* p, size_t i, Node*, Node*)  // unchecked: node and index only
+        : curr{ p }, idx{ i } { }
+#endif
+
+    iterator& operator++()  // forward
+    {
+        HOMEMADE_CHECK(curr != last, throw std::out_of_range("increment beyond end()"));
+        if (++idx == curr->count) {
+            curr = curr->succ;
+            idx = 0;
+        }
+        return *this;
+    }
+    iterator& operator--() // backward
+    {
+        if (idx > 0) {
+            --idx;
+            return *this;
+        }
+        HOMEMADE_CHECK(curr->prev != first, throw std::out_of_range("decrement beyond begin()"));
+        curr = curr->prev;
+        idx = curr->count - 1;
+        return *this;
+    }
+    Elem& operator*() // get value (dereference)
+    {
+        HOMEMADE_CHECK(curr != first && curr != last,  // first and last are not to be accessed
+            throw std::out_of_range("dereference beyond range"));
+        return curr->val()[idx];
+    }
+    const Elem& operator*() const // get value (dereference)
+    {
+        HOMEMADE_CHECK(curr != first && curr != last,  // first and last are not to be accessed
+            throw std::out_of_range("dereference beyond range"));
+        return curr->val()[idx];
+    }
+    Elem* operator->() { return &**this; }
+
+    bool operator==(const iterator& b) const { return curr == b.curr && idx == b.idx; }
+    bool operator!=(const iterator& b) const { return !(*this == b); }
+
+    Node* node() const { return curr; }
+    size_t index() const { return idx; }
+
+private:
+    Node* curr; // current node
+    size_t idx; // position inside curr
+#if HOMEMADE_CHECK_LEVEL > 0
+    // storing first last to impose iterator check
+    Node* first;
+    Node* last;
+#endif
+};
+
+template<typename Elem, size_t N, typename A>
+typename unrolled_list<Elem, N, A>::Node* unrolled_list<Elem, N, A>::new_node_after(Node* n)
+{
+    Node* p = node_traits::allocate(alloc, 1);
+    p->count = 0;
+    p->prev = n;
+    p->succ = n->succ;
+    n->succ->prev = p;
+    n->succ = p;
+    return p;
+}
+
+template<typename Elem, size_t N, typename A>
+void unrolled_list<Elem, N, A>::swap_nodes(unrolled_list<Elem, N, A>& l) noexcept
+{
+    std::swap(first, l.first);
+    std::swap(last, l.last);
+    std::swap(sz, l.sz);
+}
+
+template<typename Elem, size_t N, typename A>
+void unrolled_list<Elem, N, A>::free_node(Node* n)
+// unlink an empty node and give it back
+{
+    n->prev->succ = n->succ;
+    n->succ->prev = n->prev;
+    node_traits::deallocate(alloc, n, 1);
+}
+
+template<typename Elem, size_t N, typename A>
+typename unrolled_list<Elem, N, A>::iterator unrolled_list<Elem, N, A>::insert(
+    unrolled_list<Elem, N, A>::iterator p, const Elem& v)
+{
+    Node* n = p.node();
+    size_t i = p.index();
+    if (n == first) throw std::out_of_range("attempting to insert before first");
+
+    Elem val(v);    // v may live in a node we are about to split
+
+    if (n == last) {    // append to the last node, if it has room
+        n = last->prev;
+        if (n == first || n->count == N)
+            n = new_node_after(n);
+        i = n->count;
+    }
+    else if (n->count == N) {   // split: the upper half moves to a new node
+        Node* m = new_node_after(n);
+        size_t half = N / 2;
+        for (size_t k = half; k < N; ++k) {
+            ::new(static_cast<void*>(&m->val()[k - half])) Elem(std::move_if_noexcept(n->val()[k]));
+            n->val()[k].~Elem();
+        }
+        m->count = N - half;
+        n->count = half;
+        if (i > half) {
+            n = m;
+            i -= half;
+        }
+    }
+
+    Elem* e = n->val();
+    if (i == n->count)
+        ::new(static_cast<void*>(&e[i])) Elem(std::move(val));
+    else {
+        // open a slot at i by shifting the rest of the node right
+        ::new(static_cast<void*>(&e[n->count])) Elem(std::move(e[n->count - 1]));
+        std::move_backward(e + i, e + n->count - 1, e + n->count);
+        e[i] = std::move(val);
+    }
+    ++n->count;
+    ++sz;
+
+    return iterator(n, i, first, last);
+}
+
+template<typename Elem, size_t N, typename A>
+typename unrolled_list<Elem, N, A>::iterator unrolled_list<Elem, N, A>::erase(
+    unrolled_list<Elem, N, A>::iterator p)
+{
+    if (sz == 0) throw std::runtime_error("empty list");   // empty list
+    Node* n = p.node();
+    size_t i = p.index();
+    // trying to erase end() or first
+    if (n == last) throw std::out_of_range("attempting to erase end()");
+    if (n == first) throw std::out_of_range("attempting to erase before begin()");
+
+    Elem* e = n->val();
+    std::move(e + i + 1, e + n->count, e + i);  // close the gap
+    e[--n->count].~Elem();
+    --sz;
+
+    if (n->count == 0) {
+        Node* s = n->succ;
+        free_node(n);
+        return iterator(s, 0, first, last);
+    }
+
+    // merge with the successor when both are sparse
+    Node* s = n->succ;
+    if (n->count < N / 4 && s != last && n->count + s->count <= N / 2) {
+        for (size_t k = 0; k < s->count; ++k) {
+            ::new(static_cast<void*>(&e[n->count + k])) Elem(std::move_if_noexcept(s->val()[k]));
+            s->val()[k].~Elem();
+        }
+        n->count += s->count;
+        free_node(s);
+    }
+
+    if (i == n->count)      // erased the last element of the node
+        return iterator(n->succ, 0, first, last);
+    return iterator(n, i, first, last);   // return value after p prior to removal
+}
+
+template<typename Elem, size_t N, typename A>
+void unrolled_list<Elem, N, A>::pop_back()
+{
+    if (sz == 0) throw std::runtime_error("empty list");
+    Node* n = last->prev;
+    erase(iterator(n, n->count - 1, first, last));
+}
+
+template<typename Elem, size_t N, typename A>
+Elem& unrolled_list<Elem, N, A>::front()
+{
+    if (sz == 0) throw std::runtime_error("empty list");
+    return first->succ->val()[0];
+}
+
+template<typename Elem, size_t N, typename A>
+Elem& unrolled_list<Elem, N, A>::back()
+{
+    if (sz == 0) throw std::runtime_error("empty list");
+    return last->prev->val()[last->prev->count - 1];
+}
+
+template<typename Elem, size_t N, typename A>
+const Elem& unrolled_list<Elem, N, A>::front() const
+{
+    if (sz == 0) throw std::runtime_error("empty list");
+    return first->succ->val()[0];
+}
+
+template<typename Elem, size_t N, typename A>
+const Elem& unrolled_list<Elem, N, A>::back() const
+{
+    if (sz == 0) throw std::runtime_error("empty list");
+    return last->prev->val()[last->prev->count - 1];
+}
+
+template<typename Elem, size_t N, typename A>
+void unrolled_list<Elem, N, A>::clear()
+{
+    Node* temp = nullptr; // storing p->succ, because after deleted, p->succ causes segfault
+    for (Node* p = first->succ; p != last; p = temp) {
+        temp = p->succ;
+        for (size_t k = 0; k < p->count; ++k)
+            p->val()[k].~Elem();
+        node_traits::deallocate(alloc, p, 1);
+    }
+
+    // link first and last
+    first->succ = last;
+    last->prev = first;
+    sz = 0;
+}
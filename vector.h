@@ -1,15 +1,111 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <memory>
 #include <sstream>
+#include <type_traits>
+#include <utility>
+
+#include "check.h"
  // homebrew vector
 
-template<typename T, typename A = std::allocator<T>> // read "for all types T" (just like in math)
+// A type is trivially relocatable when moving it to a new address and forgetting
+// the old one is the same as copying its bytes. Trivially copyable types qualify
+// automatically; other types (e.g. a handle owning a single pointer) may opt in
+// by specializing this trait.
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> { };
+
+// Allocators that can resize a block themselves (e.g. mmap_allocator through
+// mremap) provide T* reallocate(T* p, size_t old_n, size_t new_n). vector uses
+// it for trivially relocatable T, so growth does not copy the elements.
+template<typename A, typename = void>
+struct has_reallocate : std::false_type { };
+
+template<typename A>
+struct has_reallocate<A, std::void_t<decltype(std::declval<A&>().reallocate(
+    std::declval<typename A::value_type*>(), size_t{}, size_t{}))>> : std::true_type { };
+
+template<typename T, typename A>
+void uninitialized_relocate(A& alloc, T* src, size_t n, T* dst)
+// move n elements from src into the uninitialized memory at dst and destroy
+// the originals; if a copy throws, dst is cleaned up and src is left intact
+{
+    if constexpr (is_trivially_relocatable<T>::value) {
+        if (n != 0)
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+    }
+    else {
+        size_t i = 0;
+        try {
+            for (; i < n; ++i)
+                std::allocator_traits<A>::construct(alloc, &dst[i], std::move_if_noexcept(src[i]));  // copies only if moving may throw
+        }
+        catch (...) {
+            for (size_t j = 0; j < i; ++j) std::allocator_traits<A>::destroy(alloc, &dst[j]);
+            throw;
+        }
+        for (i = 0; i < n; ++i) std::allocator_traits<A>::destroy(alloc, &src[i]);
+    }
+}
+
+// Assumed size of a cache line. Data written by different threads is kept
+// this far apart so the threads don't fight over one line.
+constexpr size_t cache_line = 64;
+
+// Growth policies: tell a vector how big its next allocation should be once
+// it runs out of space. next() gets the current allocation, the number of
+// elements that must fit and sizeof(T), and returns a capacity >= needed.
+
+struct growth_factor_2 {
+    // classic doubling, starting with space for 8 elements; few reallocations,
+    // up to 50% of the allocation unused
+    static size_t next(size_t space, size_t needed, size_t /*elem_size*/)
+    {
+        size_t newalloc = space == 0 ? 8 : 2 * space;
+        return newalloc < needed ? needed : newalloc;
+    }
+};
+
+struct growth_factor_1_5 {
+    // grow by half; at most 33% unused, and freed blocks can eventually
+    // be reused by later, larger allocations
+    static size_t next(size_t space, size_t needed, size_t /*elem_size*/)
+    {
+        size_t newalloc = space < 4 ? 4 : space + space / 2;
+        return newalloc < needed ? needed : newalloc;
+    }
+};
+
+struct growth_size_class {
+    // grow by half, then round the byte size up to the allocator's size class,
+    // so the slack malloc would hand out anyway becomes usable capacity.
+    // Classes follow the common layout: 16 byte steps up to 128 bytes,
+    // then 4 classes per power of two.
+    static size_t round_to_class(size_t bytes)
+    {
+        if (bytes <= 128) return (bytes + 15) & ~size_t{ 15 };
+        size_t pow = 128;
+        while (pow * 2 < bytes) pow *= 2;       // pow < bytes <= 2 * pow
+        size_t step = pow / 4;
+        return (bytes + step - 1) / step * step;
+    }
+
+    static size_t next(size_t space, size_t needed, size_t elem_size)
+    {
+        size_t newalloc = growth_factor_1_5::next(space, needed, elem_size);
+        return round_to_class(newalloc * elem_size) / elem_size;
+    }
+};
+
+template<typename T, typename A = std::allocator<T>, typename G = growth_factor_2> // read "for all types T" (just like in math)
 class vector {
 public:
     using size_type = size_t;
     using value_type = T;
+    using growth_policy = G;
     using iterator = T*;
     using const_iterator = const T*;
 
@@ -29,29 +125,29 @@ public:
     }
 
     vector(size_type s, T val)
-        : sz{ s }, space{ s }, elem{ alloc.allocate(s) }
+        : sz{ s }, space{ s }, elem{ alloc_traits::allocate(alloc, s) }
     {
         for (size_type i = 0; i < s; ++i)
-            alloc.construct(&elem[i], val);      // initialize elements
+            alloc_traits::construct(alloc, &elem[i], val);      // initialize elements
     }
 
     vector(std::initializer_list<T> lst)
-        : sz{ lst.size() }, space{ lst.size() }, elem{ alloc.allocate(lst.size()) }  // uninitialized memory for elements
+        : sz{ lst.size() }, space{ lst.size() }, elem{ alloc_traits::allocate(alloc, lst.size()) }  // uninitialized memory for elements
     {
         auto it = lst.begin();
         for (size_type i = 0; i < lst.size(); ++i) {
-            alloc.construct(&elem[i], *it);
+            alloc_traits::construct(alloc, &elem[i], *it);
             ++it;
         }
     }
 
     vector(const vector& arg)
     // allocate elements, then initialize them by copying
-        : sz{ arg.sz }, space{ arg.sz }, elem{ alloc.allocate(arg.sz) }
+        : sz{ arg.sz }, space{ arg.sz }, elem{ alloc_traits::allocate(alloc, arg.sz) }
     {
         auto it = arg.begin();
         for (size_type i = 0; i < arg.size(); ++i) {
-            alloc.construct(&elem[i], *it);
+            alloc_traits::construct(alloc, &elem[i], *it);
             ++it;
         }
     }
@@ -60,16 +156,23 @@ public:
     {
         if (this == &a) return *this;       // self_assignment, no work needed
 
-        std::unique_ptr<T[]> p{ alloc.allocate(a.sz) };       // allocate new space                    
-
-        for (size_type i = 0; i < a.sz; ++i)     // copy elements
-            alloc.construct(&p.get()[i], a.elem[i]);
+        T* p = alloc_traits::allocate(alloc, a.sz);        // allocate new space
+        size_type i = 0;
+        try {
+            for (; i < a.sz; ++i)           // copy elements
+                alloc_traits::construct(alloc, &p[i], a.elem[i]);
+        }
+        catch (...) {
+            for (size_type j = 0; j < i; ++j) alloc_traits::destroy(alloc, &p[j]);
+            alloc_traits::deallocate(alloc, p, a.sz);      // the allocator's memory goes back to the allocator
+            throw;
+        }
 
         for (size_type i = 0; i < sz; ++i)  // deallocate old space
-            alloc.destroy(&elem[i]);  
+            alloc_traits::destroy(alloc, &elem[i]);
 
-        alloc.deallocate(elem, space);
-        elem = p.release();                           // now we can reset elem
+        alloc_traits::deallocate(alloc, elem, space);
+        elem = p;                           // now we can reset elem
         space = a.sz;
         sz = a.sz;
         return *this;
@@ -87,8 +190,8 @@ public:
     {
         if (this == &a) return *this;  // self assignment
 
-        for (size_type i = 0; i < sz; ++i) alloc.destroy(&elem[i]);
-        alloc.deallocate(space);      // deallocate old space
+        for (size_type i = 0; i < sz; ++i) alloc_traits::destroy(alloc, &elem[i]);
+        alloc_traits::deallocate(alloc, elem, space);    // deallocate old space
         elem = a.elem;                // copy a's elem and sz
         sz = a.sz;
         space = a.space;
@@ -101,8 +204,8 @@ public:
     ~vector()
     {
         for (size_type i = 0; i < sz; ++i)
-            alloc.destroy(&elem[i]);
-        alloc.deallocate(elem, space);
+            alloc_traits::destroy(alloc, &elem[i]);
+        alloc_traits::deallocate(alloc, elem, space);
     }
 
     T& operator[](size_type n)
@@ -117,18 +220,14 @@ public:
 
     T& at(size_type n)
     {
-        std::stringstream ss;
-        ss << "Size = " << sz << ", Access = " << n;
-        if (n < 0 || sz <= n)
-            throw std::out_of_range(ss.str());
+        HOMEMADE_CHECK(n < sz, range_error(n));
+        return elem[n];
     }
 
     const T& at(size_type n) const
     {
-        std::stringstream ss;
-        ss << "Size = " << sz << ", Access = " << n;
-        if (n < 0 || sz <= n)
-            throw std::out_of_range(ss.str());
+        HOMEMADE_CHECK(n < sz, range_error(n));
+        return elem[n];
     }
 
     size_type capacity() const
@@ -139,63 +238,300 @@ public:
     void reserve(size_type newalloc)
     {
         if (newalloc <= space) return;      // never decrease allocation
-        std::unique_ptr<T[]> p{ alloc.allocate(newalloc) };    // allocate new space
-        for (size_type i = 0; i < sz; ++i) alloc.construct(&p[i], elem[i]);   // copy
-        for (size_type i = 0; i < sz; ++i) alloc.destroy(&elem[i]);           // destroy
-        alloc.deallocate(elem, space);      // deallocate old space
-        elem = p.release();
+        if (reallocate(newalloc)) return;   // the allocator resized the block for us
+        T* p = alloc_traits::allocate(alloc, newalloc);    // allocate new space
+        try {
+            uninitialized_relocate(alloc, elem, sz, p);   // move (or memcpy) elements over
+        }
+        catch (...) {
+            alloc_traits::deallocate(alloc, p, newalloc);
+            throw;
+        }
+        alloc_traits::deallocate(alloc, elem, space);      // deallocate old space
+        elem = p;
         space = newalloc;
     }
 
+    void shrink_to_fit()
+    // give back the unused part of the allocation
+    {
+        if (sz == space) return;
+        if (sz != 0 && reallocate(sz)) return;
+        T* p = sz == 0 ? nullptr : alloc_traits::allocate(alloc, sz);
+        try {
+            uninitialized_relocate(alloc, elem, sz, p);
+        }
+        catch (...) {
+            alloc_traits::deallocate(alloc, p, sz);
+            throw;
+        }
+        alloc_traits::deallocate(alloc, elem, space);
+        elem = p;
+        space = sz;
+    }
+
     void resize(size_type newsize, T val)
     // make the vector have newsize elements
     // intitialize each new element with the default value
     {
         reserve(newsize);
-        for (size_type i = sz; i < newsize; ++i) alloc.construct(&elem[i], val);  // construct
-        for (size_type i = newsize; i < sz; ++i) alloc.destroy(&elem[i]);         // destroy
+        for (size_type i = sz; i < newsize; ++i) alloc_traits::construct(alloc, &elem[i], val);  // construct
+        for (size_type i = newsize; i < sz; ++i) alloc_traits::destroy(alloc, &elem[i]);         // destroy
         sz = newsize;
     }
 
     void push_back(const T& val)
     // increase vector size by one; intialize the new element with d
     {
-        if (space == 0)
-            reserve(8);                 // start with space for 8 elements
-        else if (sz == space)
-            reserve(2 * space);         // get more space
-        alloc.construct(&elem[sz], val);// add val at end
-        ++sz;                           // increase the size (sz is the number of elements)
+        emplace_back(val);
+    }
+
+    void push_back(T&& val)
+    // same as above, but steals val's representation
+    {
+        emplace_back(std::move(val));
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args)
+    // construct the new element in place at elem[sz] from args
+    {
+        if (sz == space && can_reallocate) {
+            T val(std::forward<Args>(args)...);     // args may refer into the block about to move
+            reserve(next_capacity(sz + 1));
+            alloc_traits::construct(alloc, &elem[sz], std::move(val));
+        }
+        else if (sz == space) {
+            // build the new element in the new space before relocating the old ones,
+            // so args may still refer to an element of this vector
+            size_type newalloc = next_capacity(sz + 1);
+            T* p = alloc_traits::allocate(alloc, newalloc);
+            try {
+                alloc_traits::construct(alloc, &p[sz], std::forward<Args>(args)...);
+            }
+            catch (...) {
+                alloc_traits::deallocate(alloc, p, newalloc);
+                throw;
+            }
+            try {
+                uninitialized_relocate(alloc, elem, sz, p);
+            }
+            catch (...) {
+                alloc_traits::destroy(alloc, &p[sz]);
+                alloc_traits::deallocate(alloc, p, newalloc);
+                throw;
+            }
+            alloc_traits::deallocate(alloc, elem, space);
+            elem = p;
+            space = newalloc;
+        }
+        else
+            alloc_traits::construct(alloc, &elem[sz], std::forward<Args>(args)...);
+        return elem[sz++];              // increase the size (sz is the number of elements)
+    }
+
+    void pop_back()
+    // destroy the last element; its space stays allocated
+    {
+        alloc_traits::destroy(alloc, &elem[--sz]);
     }
 
     iterator erase(iterator p)
     {
         if (p == end()) return p;
-        for (auto pos = p + 1; pos != end(); ++pos)
-            *(pos - 1) = *pos;          // copy element "one position to the left"
-        alloc.destroy(end() - 1);         // destroy surplus copy of last element
-        --sz;
-        return p;
+        return erase(p, p + 1);
+    }
+
+    iterator erase(iterator first, iterator last)
+    // remove [first, last), shifting the tail left only once
+    {
+        if (first == last) return first;
+        size_type n = last - first;
+        if constexpr (is_trivially_relocatable<T>::value) {
+            for (auto pos = first; pos != last; ++pos) alloc_traits::destroy(alloc, pos);
+            std::memmove(static_cast<void*>(first), static_cast<const void*>(last), (end() - last) * sizeof(T));
+        }
+        else {
+            std::move(last, end(), first);  // move the tail "n positions to the left"
+            for (auto pos = end() - n; pos != end(); ++pos)
+                alloc_traits::destroy(alloc, pos);         // destroy surplus moved-from elements
+        }
+        sz -= n;
+        return first;
+    }
+
+    iterator insert(iterator p, size_type count, const T& val)
+    // insert count copies of val before p
+    {
+        size_type index = p - begin();
+        if (count == 0) return begin() + index;
+
+        T v(val);                           // val may refer to an element about to be shifted
+        if constexpr (is_trivially_relocatable<T>::value) {
+            T* gap = open_gap(index, count);
+            for (size_type i = 0; i < count; ++i)
+                alloc_traits::construct(alloc, &gap[i], v);
+            sz += count;
+        }
+        else {
+            if (space < sz + count)
+                reserve(next_capacity(sz + count));
+            size_type oldsz = sz;
+            for (size_type i = 0; i < count; ++i)
+                emplace_back(v);
+            std::rotate(begin() + index, begin() + oldsz, end());   // bring the new elements into place
+        }
+        return begin() + index;
+    }
+
+    template<typename Iter, typename = typename std::iterator_traits<Iter>::iterator_category>
+    iterator insert(iterator p, Iter first, Iter last)
+    // insert copies of [first, last) before p; [first, last) must not point into *this
+    {
+        using category = typename std::iterator_traits<Iter>::iterator_category;
+        size_type index = p - begin();
+
+        if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+            size_type count = std::distance(first, last);   // known up front: allocate once
+            if (count == 0) return begin() + index;
+
+            if constexpr (is_trivially_relocatable<T>::value) {
+                T* gap = open_gap(index, count);
+                size_type i = 0;
+                try {
+                    for (; first != last; ++first, ++i)
+                        alloc_traits::construct(alloc, &gap[i], *first);
+                }
+                catch (...) {
+                    for (size_type j = 0; j < i; ++j) alloc_traits::destroy(alloc, &gap[j]);
+                    close_gap(index, count);
+                    throw;
+                }
+                sz += count;
+                return begin() + index;
+            }
+            else if (space < sz + count)
+                reserve(next_capacity(sz + count));
+        }
+
+        // append, then rotate the new elements into place
+        size_type oldsz = sz;
+        for (; first != last; ++first)
+            emplace_back(*first);
+        std::rotate(begin() + index, begin() + oldsz, end());
+        return begin() + index;
+    }
+
+    template<typename R>
+    void append_range(R&& r)
+    // add the elements of r at the end
+    {
+        using std::begin;
+        using std::end;
+        insert(this->end(), begin(r), end(r));
     }
 
     iterator insert(iterator p, const T& val)
+    {
+        return emplace(p, val);
+    }
+
+    iterator insert(iterator p, T&& val)
+    {
+        return emplace(p, std::move(val));
+    }
+
+    template<typename... Args>
+    iterator emplace(iterator p, Args&&... args)
+    // construct a new element from args before p
     {
         size_type index = p - begin();    // yielding amount of blocks of memory depending on type
+        if (index == sz) {
+            emplace_back(std::forward<Args>(args)...);
+            return begin() + index;
+        }
+
+        T val(std::forward<Args>(args)...);     // args may refer to an element about to be shifted
         if (size() == capacity())
-            reserve(size() == 0 ? 8 : 2 * size());      // make sure we have space
+            reserve(next_capacity(sz + 1));     // make sure we have space
 
-        // first copy last element into uninitializzed space:
-        alloc.construct(elem + sz, back());
+        // first move last element into uninitializzed space:
+        alloc_traits::construct(alloc, elem + sz, std::move(back()));
 
         ++sz;
         iterator pp = begin() + index;      // the place to put val
-        for (auto pos = &back(); pos != pp; --pos)
-            *pos = *(pos - 1);              // copy elements one position to the right
-        *(begin() + index) = val;           // "insert" val
+        std::move_backward(pp, end() - 2, end() - 1);   // move elements one position to the right
+        *pp = std::move(val);               // "insert" val
         return pp;
     }
 
 private:
+    [[noreturn]] void range_error(size_type n) const
+    // kept out of at(), so the message is only formatted when the check fails
+    {
+        std::stringstream ss;
+        ss << "Size = " << sz << ", Access = " << n;
+        throw std::out_of_range(ss.str());
+    }
+
+    size_type next_capacity(size_type needed) const
+    // the allocation to grow to when we need room for needed elements
+    {
+        return G::next(space, needed, sizeof(T));
+    }
+
+    static constexpr bool can_reallocate = has_reallocate<A>::value && is_trivially_relocatable<T>::value;
+
+    bool reallocate(size_type newalloc)
+    // let the allocator resize the block in place (or remap it) when it can;
+    // returns false when the elements have to be relocated by hand
+    {
+        if constexpr (can_reallocate) {
+            if (elem == nullptr) return false;
+            elem = alloc.reallocate(elem, space, newalloc);
+            space = newalloc;
+            return true;
+        }
+        else
+            return false;
+    }
+
+    T* open_gap(size_type index, size_type n)
+    // for trivially relocatable T only: make [index, index + n) uninitialized
+    // by sliding the tail up with a single memmove (or memcpy into new space);
+    // the elements in the gap are not counted in sz yet
+    {
+        size_type tail = sz - index;
+        if (space < sz + n && reallocate(next_capacity(sz + n))) {
+            if (tail != 0)
+                std::memmove(static_cast<void*>(elem + index + n), static_cast<const void*>(elem + index), tail * sizeof(T));
+        }
+        else if (space < sz + n) {
+            size_type newalloc = next_capacity(sz + n);
+            T* p = alloc_traits::allocate(alloc, newalloc);
+            if (index != 0)
+                std::memcpy(static_cast<void*>(p), static_cast<const void*>(elem), index * sizeof(T));
+            if (tail != 0)
+                std::memcpy(static_cast<void*>(p + index + n), static_cast<const void*>(elem + index), tail * sizeof(T));
+            alloc_traits::deallocate(alloc, elem, space);
+            elem = p;
+            space = newalloc;
+        }
+        else if (tail != 0)
+            std::memmove(static_cast<void*>(elem + index + n), static_cast<const void*>(elem + index), tail * sizeof(T));
+        return elem + index;
+    }
+
+    void close_gap(size_type index, size_type n)
+    // undo open_gap after a failed construction
+    {
+        size_type tail = sz - index;
+        if (tail != 0)
+            std::memmove(static_cast<void*>(elem + index), static_cast<const void*>(elem + index + n), tail * sizeof(T));
+    }
+
+    using alloc_traits = std::allocator_traits<A>;
+
     A alloc;            // use allocate to handle memory for elements
     size_type sz;       // the size
     value_type* elem;   // pointer to the first element (of type T)
@@ -203,13 +539,16 @@ private:
                          // for new elements ("the current allocation")
 };
 
+#include "vector_bool.h"    // vector<bool>: one bit per element
+
 // Deklarasi
 /*
-template<typename T, typename A = std::allocator<T>> // read "for all types T" (just like in math)
+template<typename T, typename A = std::allocator<T>, typename G = growth_factor_2> // read "for all types T" (just like in math)
 class vector {
 public:
     using size_type = size_t;
     using value_type = T;
+    using growth_policy = G;
     using iterator = T*;
     using const_iterator = const T*;
 
@@ -219,7 +558,16 @@ public:
     const_iterator end() const;
 
     iterator erase(iterator p);
+    iterator erase(iterator first, iterator last);      // remove a range, shifting once
     iterator insert(iterator p, const T& val);          // insert before
+    iterator insert(iterator p, T&& val);
+    iterator insert(iterator p, size_type count, const T& val);
+    template<typename Iter>
+    iterator insert(iterator p, Iter first, Iter last); // insert a range, shifting once
+    template<typename R>
+    void append_range(R&& r);
+    template<typename... Args>
+    iterator emplace(iterator p, Args&&... args);       // construct in place before p
 
     size_type size() const;
 
@@ -230,11 +578,11 @@ public:
     explicit vector(size_type s, T val = T{});          // specifying size
     vector(std::initializer_list<T> lst);               // init-list ctor
 
-    vector(const vector<T, A>& arg);                    // copy ctor
-    vector<T, A>& operator=(const vector<T, A>& a);     // copy assignment
+    vector(const vector& arg);                          // copy ctor
+    vector& operator=(const vector& a);                 // copy assignment
 
-    vector(vector<T, A>&& a);                           // move constructor
-    vector<T, A>& operator=(vector<T, A>&& a);          // move assignment
+    vector(vector&& a);                                 // move constructor
+    vector& operator=(vector&& a);                      // move assignment
 
     ~vector();                                          // dtor
 
@@ -246,8 +594,13 @@ public:
 
     void reserve(size_type newalloc);                   // configuring free space
     size_type capacity() const;
+    void shrink_to_fit();                               // drop unused space
     void resize(size_type newsize, T val = T{});
     void push_back(const T& d);
+    void push_back(T&& d);
+    template<typename... Args>
+    T& emplace_back(Args&&... args);                    // construct in place at end
+    void pop_back();                                    // destroy the last element
 
 private:
     A alloc;            // use allocate to handle memory for elements
@@ -0,0 +1,568 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "vector.h"
+
+/**
+ * vector<bool> yang dikemas 1 bit per elemen dalam word 64 bit, 8x lebih
+ * hemat memori (dan cache) daripada 1 byte per elemen. Elemen diakses lewat
+ * proxy reference; operasi massal bekerja per word:
+ *
+ *     vector<bool> hits(n);
+ *     hits[i] = true;
+ *     hits &= allowed;                    // sizes must match
+ *     for (size_t i = hits.find_first(); i != hits.npos; i = hits.find_next(i))
+ *         ...
+ *
+ * Bits past size() in the last word are kept zero, so count(), find and the
+ * bitwise operations can work on whole words. When compiled with AVX2
+ * (__AVX2__) the kernels below take 256 bits per step; otherwise they loop
+ * over words, using the compiler's popcount and count-trailing-zeros.
+ * insert and erase keep the interface of the generic vector and shift the
+ * tail 64 bits at a time.
+ */
+
+using bit_word = uint64_t;
+constexpr size_t bits_per_word = 64;
+
+inline size_t popcount_word(bit_word x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX2__)
+    return __popcnt64(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555);
+    x = (x & 0x3333333333333333) + ((x >> 2) & 0x3333333333333333);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0f;
+    return (x * 0x0101010101010101) >> 56;
+#endif
+}
+
+inline size_t lowest_bit(bit_word x)
+// index of the lowest set bit; x must not be 0
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return i;
+#else
+    size_t i = 0;
+    for (; (x & 1) == 0; x >>= 1) ++i;
+    return i;
+#endif
+}
+
+//==============================================================================
+// Kernels over arrays of n words
+
+inline size_t bits_count(const bit_word* w, size_t n)
+// number of set bits
+{
+    size_t i = 0;
+    size_t total = 0;
+#if defined(__AVX2__)
+    // popcount of each nibble by table lookup (vpshufb), summed per 64-bit
+    // lane with vpsadbw (Mula, Kurz and Lemire)
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+        __m256i lo = _mm256_shuffle_epi8(table, _mm256_and_si256(v, low));
+        __m256i hi = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+    }
+    total = static_cast<size_t>(_mm256_extract_epi64(acc, 0)) + static_cast<size_t>(_mm256_extract_epi64(acc, 1))
+        + static_cast<size_t>(_mm256_extract_epi64(acc, 2)) + static_cast<size_t>(_mm256_extract_epi64(acc, 3));
+#endif
+    for (; i < n; ++i) total += popcount_word(w[i]);
+    return total;
+}
+
+inline size_t bits_find_nonzero(const bit_word* w, size_t i, size_t n)
+// index of the first nonzero word in [i, n), or n
+{
+#if defined(__AVX2__)
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+        if (!_mm256_testz_si256(v, v)) break;
+    }
+#endif
+    for (; i < n; ++i)
+        if (w[i] != 0) return i;
+    return n;
+}
+
+enum class bit_op {
+    and_with,   // d & s
+    or_with,    // d | s
+    xor_with,   // d ^ s
+    and_not     // d & ~s
+};
+
+template<bit_op Op>
+bit_word bit_apply(bit_word d, bit_word s)
+{
+    if constexpr (Op == bit_op::and_with) return d & s;
+    else if constexpr (Op == bit_op::or_with) return d | s;
+    else if constexpr (Op == bit_op::xor_with) return d ^ s;
+    else return d & ~s;
+}
+
+#if defined(__AVX2__)
+template<bit_op Op>
+__m256i bit_apply(__m256i d, __m256i s)
+{
+    if constexpr (Op == bit_op::and_with) return _mm256_and_si256(d, s);
+    else if constexpr (Op == bit_op::or_with) return _mm256_or_si256(d, s);
+    else if constexpr (Op == bit_op::xor_with) return _mm256_xor_si256(d, s);
+    else return _mm256_andnot_si256(s, d);
+}
+#endif
+
+template<bit_op Op>
+void bits_combine(bit_word* d, const bit_word* s, size_t n)
+// d[i] = d[i] Op s[i] for every word
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), bit_apply<Op>(a, b));
+    }
+#endif
+    for (; i < n; ++i) d[i] = bit_apply<Op>(d[i], s[i]);
+}
+
+//==============================================================================
+
+class bit_reference {
+    // proxy for one bit of a word array
+public:
+    bit_reference(bit_word* w, bit_word mask)
+        : w{ w }, mask{ mask } { }
+
+    operator bool() const { return (*w & mask) != 0; }
+
+    bit_reference& operator=(bool x)
+    {
+        if (x) *w |= mask;
+        else *w &= ~mask;
+        return *this;
+    }
+    bit_reference& operator=(const bit_reference& r) { return *this = static_cast<bool>(r); }
+
+    void flip() { *w ^= mask; }
+
+    friend void swap(bit_reference a, bit_reference b)     // swaps the bits, not the proxies
+    {
+        bool t = a;
+        a = b;
+        b = t;
+    }
+
+private:
+    bit_word* w;        // the word holding the bit
+    bit_word mask;      // the bit within it
+};
+
+template<bool Const>
+class bit_iterator {
+    // random access over the bits of a word array; the const one yields
+    // plain bools, the other one proxies
+    using word_ptr = std::conditional_t<Const, const bit_word*, bit_word*>;
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = bool;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::conditional_t<Const, bool, bit_reference>;
+
+    bit_iterator(word_ptr w, size_t i)
+        : w{ w }, idx{ i } { }
+
+    template<bool C = Const, typename = std::enable_if_t<C>>
+    bit_iterator(const bit_iterator<false>& it)     // iterator to const_iterator
+        : w{ it.w }, idx{ it.idx } { }
+
+    bit_iterator& operator++() { ++idx; return *this; }  // forward
+    bit_iterator& operator--() { --idx; return *this; }  // backward
+    bit_iterator operator++(int) { bit_iterator t = *this; ++idx; return t; }
+    bit_iterator operator--(int) { bit_iterator t = *this; --idx; return t; }
+
+    bit_iterator& operator+=(difference_type n) { idx += n; return *this; }
+    bit_iterator& operator-=(difference_type n) { idx -= n; return *this; }
+    bit_iterator operator+(difference_type n) const { return bit_iterator(w, idx + n); }
+    bit_iterator operator-(difference_type n) const { return bit_iterator(w, idx - n); }
+    difference_type operator-(const bit_iterator& b) const { return static_cast<difference_type>(idx - b.idx); }
+
+    reference operator*() const
+    {
+        word_ptr p = w + idx / bits_per_word;
+        bit_word mask = bit_word{ 1 } << (idx % bits_per_word);
+        if constexpr (Const) return (*p & mask) != 0;
+        else return bit_reference(p, mask);
+    }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    bool operator==(const bit_iterator& b) const { return idx == b.idx; }
+    bool operator!=(const bit_iterator& b) const { return idx != b.idx; }
+    bool operator<(const bit_iterator& b) const { return idx < b.idx; }
+    bool operator>(const bit_iterator& b) const { return idx > b.idx; }
+    bool operator<=(const bit_iterator& b) const { return idx <= b.idx; }
+    bool operator>=(const bit_iterator& b) const { return idx >= b.idx; }
+
+    size_t index() const { return idx; }
+
+private:
+    friend class bit_iterator<true>;
+
+    word_ptr w;     // the words of the vector
+    size_t idx;     // position in the vector
+};
+
+template<typename A, typename G>
+class vector<bool, A, G> {
+    using word = bit_word;
+    using word_vector = vector<word, typename std::allocator_traits<A>::template rebind_alloc<word>, G>;
+public:
+    using size_type = size_t;
+    using value_type = bool;
+    using growth_policy = G;
+
+    static constexpr size_type npos = ~size_type{ 0 };
+
+    using reference = bit_reference;    // proxy for one bit
+    using iterator = bit_iterator<false>;
+    using const_iterator = bit_iterator<true>;
+
+    iterator begin() { return iterator(words.begin(), 0); }
+    iterator end() { return iterator(words.begin(), sz); }
+    const_iterator begin() const { return const_iterator(words.begin(), 0); }
+    const_iterator end() const { return const_iterator(words.begin(), sz); }
+
+    size_type size() const { return sz; }
+    bool empty() const { return sz == 0; }
+    size_type capacity() const { return words.capacity() * bits_per_word; }
+
+    vector() { }
+
+    explicit vector(size_type s, bool val = false)
+        : sz{ s }, words(word_count(s), val ? ~word{ 0 } : word{ 0 })
+    {
+        clear_tail();
+    }
+
+    vector(std::initializer_list<bool> lst)
+    {
+        reserve(lst.size());
+        for (bool x : lst)
+            push_back(x);
+    }
+
+    vector(const vector&) = default;
+    vector& operator=(const vector&) = default;
+
+    vector(vector&& v)
+        : sz{ v.sz }, words{ std::move(v.words) }
+    {
+        v.sz = 0;
+    }
+
+    vector& operator=(vector&& v)
+    {
+        if (this == &v) return *this;  // self assignment
+
+        words = std::move(v.words);
+        sz = v.sz;
+        v.sz = 0;
+        return *this;
+    }
+
+    reference operator[](size_type n) { return reference(&words[n / bits_per_word], bit(n)); }
+    bool operator[](size_type n) const { return (words[n / bits_per_word] & bit(n)) != 0; }
+
+    reference at(size_type n)
+    {
+        HOMEMADE_CHECK(n < sz, throw std::out_of_range("Size = " + std::to_string(sz) + ", Access = " + std::to_string(n)));
+        return (*this)[n];
+    }
+
+    bool at(size_type n) const
+    {
+        HOMEMADE_CHECK(n < sz, throw std::out_of_range("Size = " + std::to_string(sz) + ", Access = " + std::to_string(n)));
+        return (*this)[n];
+    }
+
+    reference front() { return (*this)[0]; }
+    reference back() { return (*this)[sz - 1]; }
+    bool front() const { return (*this)[0]; }
+    bool back() const { return (*this)[sz - 1]; }
+
+    void reserve(size_type newalloc) { words.reserve(word_count(newalloc)); }
+    void shrink_to_fit() { words.shrink_to_fit(); }
+
+    void resize(size_type newsize, bool val = false)
+    {
+        if (newsize > sz) {
+            words.resize(word_count(newsize), word{ 0 });
+            if (val) fill(sz, newsize, true);
+        }
+        else
+            words.erase(words.begin() + word_count(newsize), words.end());
+        sz = newsize;
+        clear_tail();
+    }
+
+    void push_back(bool val)
+    {
+        if (sz % bits_per_word == 0) words.push_back(word{ 0 });
+        if (val) words[sz / bits_per_word] |= bit(sz);
+        ++sz;
+    }
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args)
+    {
+        push_back(bool(std::forward<Args>(args)...));
+        return back();
+    }
+
+    void pop_back()
+    {
+        --sz;
+        words[sz / bits_per_word] &= ~bit(sz);
+        if (sz % bits_per_word == 0) words.pop_back();
+    }
+
+    void clear()
+    {
+        words.erase(words.begin(), words.end());
+        sz = 0;
+    }
+
+    iterator erase(const_iterator p)
+    {
+        if (p == end()) return begin() + p.index();
+        return erase(p, p + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    // remove [first, last), shifting the tail down a word at a time
+    {
+        size_type f = first.index();
+        size_type l = last.index();
+        if (f == l) return begin() + f;
+        move_bits(l, f, sz - l);
+        resize(sz - (l - f));
+        return begin() + f;
+    }
+
+    iterator insert(const_iterator p, size_type count, bool val)
+    // insert count copies of val before p
+    {
+        size_type index = p.index();
+        open_gap(index, count);
+        fill(index, index + count, val);
+        return begin() + index;
+    }
+
+    template<typename Iter, typename = typename std::iterator_traits<Iter>::iterator_category>
+    iterator insert(const_iterator p, Iter first, Iter last)
+    // insert copies of [first, last) before p; [first, last) must not point into *this
+    {
+        using category = typename std::iterator_traits<Iter>::iterator_category;
+        size_type index = p.index();
+        if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value) {
+            size_type count = std::distance(first, last);   // known up front: shift the tail once
+            open_gap(index, count);
+            for (size_type i = index; first != last; ++first, ++i)
+                if (*first) words[i / bits_per_word] |= bit(i);
+            return begin() + index;
+        }
+        else {
+            vector tmp;         // single pass: collect first
+            for (; first != last; ++first) tmp.push_back(*first);
+            return insert(p, tmp.begin(), tmp.end());
+        }
+    }
+
+    template<typename R>
+    void append_range(R&& r)
+    // add the elements of r at the end
+    {
+        using std::begin;
+        using std::end;
+        insert(this->end(), begin(r), end(r));
+    }
+
+    iterator insert(const_iterator p, bool val) { return insert(p, 1, val); }
+
+    template<typename... Args>
+    iterator emplace(const_iterator p, Args&&... args)
+    {
+        return insert(p, 1, bool(std::forward<Args>(args)...));
+    }
+
+    // word-level bulk operations
+    size_type count() const { return bits_count(words.begin(), words.size()); }  // number of true elements
+    size_type find_first() const { return find_from(0); }   // index of the first true element, or npos
+    size_type find_next(size_type pos) const { return find_from(pos + 1); }  // first true element after pos, or npos
+
+    vector& operator&=(const vector& v) { return combine<bit_op::and_with>(v); }
+    vector& operator|=(const vector& v) { return combine<bit_op::or_with>(v); }
+    vector& operator^=(const vector& v) { return combine<bit_op::xor_with>(v); }
+    vector& and_not(const vector& v) { return combine<bit_op::and_not>(v); }  // clear the elements true in v
+
+    void set(size_type first, size_type last) { check_range(first, last); fill(first, last, true); }   // [first, last) = true
+    void reset(size_type first, size_type last) { check_range(first, last); fill(first, last, false); } // [first, last) = false
+
+    void flip()
+    // negate every element
+    {
+        for (word& w : words) w = ~w;
+        clear_tail();
+    }
+
+    const word* data() const { return words.begin(); }    // the packed words, lowest index in the lowest bit
+
+    bool operator==(const vector& v) const
+    {
+        if (sz != v.sz) return false;
+        for (size_type i = 0; i < words.size(); ++i)
+            if (words[i] != v.words[i]) return false;
+        return true;
+    }
+    bool operator!=(const vector& v) const { return !(*this == v); }
+
+private:
+    static size_type word_count(size_type n) { return (n + bits_per_word - 1) / bits_per_word; }
+    static word bit(size_type n) { return word{ 1 } << (n % bits_per_word); }
+
+    void clear_tail()
+    // zero the unused bits of the last word
+    {
+        if (sz % bits_per_word != 0)
+            words[sz / bits_per_word] &= ~word{ 0 } >> (bits_per_word - sz % bits_per_word);
+    }
+
+    void check_range(size_type first, size_type last) const
+    {
+        if (first > last || last > sz)
+            throw std::out_of_range("Size = " + std::to_string(sz) + ", Range = [" + std::to_string(first) + ", " + std::to_string(last) + ")");
+    }
+
+    word load_bits(size_type pos) const
+    // the 64 bits starting at bit pos; bits past the last word read as 0
+    {
+        size_type i = pos / bits_per_word;
+        size_type o = pos % bits_per_word;
+        word w = words[i] >> o;
+        if (o != 0 && i + 1 < words.size()) w |= words[i + 1] << (bits_per_word - o);
+        return w;
+    }
+
+    void store_bits(size_type pos, word w, size_type n)
+    // write the low n bits of w (0 < n <= 64) at bit pos
+    {
+        word mask = n == bits_per_word ? ~word{ 0 } : (word{ 1 } << n) - 1;
+        w &= mask;
+        size_type i = pos / bits_per_word;
+        size_type o = pos % bits_per_word;
+        words[i] = (words[i] & ~(mask << o)) | (w << o);
+        if (o + n > bits_per_word) {
+            size_type done = bits_per_word - o;
+            words[i + 1] = (words[i + 1] & ~(mask >> done)) | (w >> done);
+        }
+    }
+
+    void move_bits(size_type from, size_type to, size_type n)
+    // copy the bits [from, from + n) to [to, to + n), 64 at a time; the
+    // ranges may overlap, so copy upwards when moving down and the other way round
+    {
+        if (to < from)
+            for (size_type k = 0; k < n; k += bits_per_word)
+                store_bits(to + k, load_bits(from + k), std::min(bits_per_word, n - k));
+        else
+            for (size_type k = n; k > 0; ) {
+                size_type m = std::min(bits_per_word, k);
+                k -= m;
+                store_bits(to + k, load_bits(from + k), m);
+            }
+    }
+
+    void open_gap(size_type index, size_type count)
+    // make room for count elements at index, all false
+    {
+        if (count == 0) return;
+        size_type oldsz = sz;
+        resize(sz + count);
+        move_bits(index, index + count, oldsz - index);
+        fill(index, index + count, false);
+    }
+
+    void fill(size_type first, size_type last, bool val)
+    // set [first, last) to val: masks for the partial words at the ends, whole words between
+    {
+        if (first == last) return;
+        size_type fw = first / bits_per_word;
+        size_type lw = (last - 1) / bits_per_word;
+        word fmask = ~word{ 0 } << (first % bits_per_word);
+        word lmask = ~word{ 0 } >> (bits_per_word - 1 - (last - 1) % bits_per_word);
+        if (fw == lw) fmask &= lmask;
+
+        if (val) words[fw] |= fmask;
+        else words[fw] &= ~fmask;
+        if (fw == lw) return;
+        for (size_type i = fw + 1; i < lw; ++i)
+            words[i] = val ? ~word{ 0 } : word{ 0 };
+        if (val) words[lw] |= lmask;
+        else words[lw] &= ~lmask;
+    }
+
+    size_type find_from(size_type n) const
+    {
+        if (n >= sz) return npos;
+        size_type i = n / bits_per_word;
+        word w = words[i] & (~word{ 0 } << (n % bits_per_word));
+        if (w == 0) {
+            i = bits_find_nonzero(words.begin(), i + 1, words.size());
+            if (i == words.size()) return npos;
+            w = words[i];
+        }
+        return i * bits_per_word + lowest_bit(w);  // the tail is zero, so this is < sz
+    }
+
+    template<bit_op Op>
+    vector& combine(const vector& v)
+    {
+        if (sz != v.sz)
+            throw std::invalid_argument("vector<bool>: sizes differ (" + std::to_string(sz) + " and " + std::to_string(v.sz) + ")");
+        bits_combine<Op>(words.begin(), v.words.begin(), words.size());
+        return *this;
+    }
+
+    size_type sz = 0;   // number of bits
+    word_vector words;  // the bits, bits_per_word to a word
+};
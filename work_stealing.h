@@ -0,0 +1,341 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "lockfree_queue.h"
+#include "vector.h"
+
+/**
+ * Work stealing: setiap worker punya deque sendiri (Chase-Lev). Pemiliknya
+ * push dan pop di ujung bawah (LIFO, tanpa lock), thread lain mencuri dari
+ * ujung atas (FIFO). Cocok untuk pekerjaan rekursif divide and conquer:
+ *
+ *     void qsort(int* b, int* e)
+ *     {
+ *         if (e - b < 4096) { std::sort(b, e); return; }
+ *         int* m = partition(b, e);
+ *         task_group g;
+ *         g.run([=] { qsort(b, m); });    // may be stolen by an idle worker
+ *         qsort(m, e);
+ *         g.wait();                       // runs other tasks while waiting
+ *     }
+ */
+
+template<typename T>
+class ws_deque {
+    // Chase-Lev deque as given for C11 atomics by Le, Pop, Cohen and Zappa
+    // Nardelli. bottom is only written by the owner; top is advanced with a
+    // CAS by thieves, and by the owner when taking the last element. The
+    // circular array grows by doubling; old arrays are kept until the deque
+    // dies, since a thief may still be reading one.
+    static_assert(std::is_trivially_copyable<T>::value, "ws_deque holds trivially copyable elements, e.g. pointers");
+public:
+    explicit ws_deque(size_t capacity = 256)
+        : arr{ new ring(pow2_at_least(capacity)) } { }
+
+    ws_deque(const ws_deque&) = delete;
+    ws_deque& operator=(const ws_deque&) = delete;
+
+    ~ws_deque()
+    {
+        delete arr.load(std::memory_order_relaxed);
+        for (ring* r : old) delete r;
+    }
+
+    void push(T x)
+    // owner only
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        ring* a = arr.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->mask)) {    // full
+            a = grow(a, t, b);
+            arr.store(a, std::memory_order_release);
+        }
+        a->put(b, x);
+        bottom.store(b + 1, std::memory_order_release);    // publishes x to thieves
+    }
+
+    bool pop(T& out)
+    // owner only: take the most recently pushed element
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        ring* a = arr.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {    // empty
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = a->get(b);
+        if (t == b) {   // last element: race the thieves for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    bool steal(T& out)
+    // any thread: take the oldest element; false if empty or another thread got it first
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return false;
+
+        ring* a = arr.load(std::memory_order_acquire);
+        T x = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return false;
+        out = x;
+        return true;
+    }
+
+    bool empty() const
+    {
+        int64_t b = bottom.load(std::memory_order_acquire);
+        return top.load(std::memory_order_acquire) >= b;
+    }
+
+private:
+    struct ring {
+        explicit ring(size_t n)
+            : mask{ n - 1 }, slots{ new std::atomic<T>[n] } { }
+
+        T get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, T x) { slots[i & mask].store(x, std::memory_order_relaxed); }
+
+        size_t mask;    // capacity - 1
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    static size_t pow2_at_least(size_t n)
+    {
+        size_t c = 2;
+        while (c < n) c *= 2;
+        return c;
+    }
+
+    ring* grow(ring* a, int64_t t, int64_t b)
+    {
+        ring* r = new ring(2 * (a->mask + 1));
+        for (int64_t i = t; i < b; ++i) r->put(i, a->get(i));
+        old.push_back(a);
+        return r;
+    }
+
+    alignas(cache_line) std::atomic<int64_t> top{ 0 };      // thieves' end
+    alignas(cache_line) std::atomic<int64_t> bottom{ 0 };   // owner's end
+    std::atomic<ring*> arr;
+    vector<ring*> old;      // outgrown arrays, owner only
+};
+
+//==============================================================================
+
+class task_group;
+
+class work_stealing_pool {
+public:
+    explicit work_stealing_pool(size_t n = std::thread::hardware_concurrency())
+    // n worker threads, each with its own deque
+        : nworkers{ n == 0 ? 1 : n }, workers{ new worker[nworkers] }
+    {
+        for (size_t i = 0; i < nworkers; ++i)
+            workers[i].th = std::thread([this, i] { work(i); });
+    }
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    ~work_stealing_pool()
+    {
+        stopping.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock{ m };
+        }
+        cv.notify_all();
+        for (size_t i = 0; i < nworkers; ++i) workers[i].th.join();
+    }
+
+    size_t size() const { return nworkers; }
+
+private:
+    friend class task_group;
+
+    struct task {
+        std::function<void()> f;
+        task_group* group;
+    };
+
+    struct worker {
+        ws_deque<task*> dq;
+        std::thread th;
+    };
+
+    static constexpr size_t npos = ~size_t{ 0 };
+
+    size_t self() const
+    // index of the calling thread among our workers, npos for other threads
+    {
+        return current_pool == this ? current_index : npos;
+    }
+
+    void spawn(task* t)
+    // a worker pushes onto its own deque; anyone else goes through the injection queue
+    {
+        size_t i = self();
+        if (i != npos) workers[i].dq.push(t);
+        else injected.push(t);
+        if (sleepers.load(std::memory_order_acquire) > 0) {
+            std::lock_guard<std::mutex> lock{ m };
+            cv.notify_one();
+        }
+    }
+
+    bool run_one(size_t i);     // find one task and run it; false if there was none
+
+    void work(size_t i)
+    {
+        current_pool = this;
+        current_index = i;
+        size_t idle = 0;
+        while (!stopping.load(std::memory_order_acquire)) {
+            if (run_one(i)) {
+                idle = 0;
+                continue;
+            }
+            if (++idle < 64) {
+                std::this_thread::yield();
+                continue;
+            }
+            // nothing found for a while: sleep until a spawn, with a timeout
+            // in case a spawn slipped in between the last look and the wait
+            std::unique_lock<std::mutex> lock{ m };
+            sleepers.fetch_add(1, std::memory_order_acq_rel);
+            cv.wait_for(lock, std::chrono::milliseconds(1));
+            sleepers.fetch_sub(1, std::memory_order_acq_rel);
+            idle = 0;
+        }
+    }
+
+    static thread_local work_stealing_pool* current_pool;
+    static thread_local size_t current_index;
+
+    size_t nworkers;
+    std::unique_ptr<worker[]> workers;
+    lockfree_queue<task*> injected;     // tasks spawned by threads outside the pool
+    std::atomic<bool> stopping{ false };
+    std::atomic<size_t> sleepers{ 0 };
+    std::mutex m;
+    std::condition_variable cv;
+};
+
+inline thread_local work_stealing_pool* work_stealing_pool::current_pool = nullptr;
+inline thread_local size_t work_stealing_pool::current_index = work_stealing_pool::npos;
+
+inline work_stealing_pool& default_ws_pool()
+// shared pool with one worker per core, started on first use
+{
+    static work_stealing_pool pool;
+    return pool;
+}
+
+class task_group {
+public:
+    explicit task_group(work_stealing_pool& pool = default_ws_pool())
+        : pool{ pool } { }
+
+    task_group(const task_group&) = delete;
+    task_group& operator=(const task_group&) = delete;
+
+    ~task_group()
+    {
+        // tasks may still refer to our caller's frame; never leave them behind
+        help_until_done();
+    }
+
+    template<typename F>
+    void run(F f)
+    // spawn f; an idle worker may steal it, otherwise wait() runs it
+    {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        auto t = new work_stealing_pool::task{ std::move(f), this };
+        pool.spawn(t);
+    }
+
+    void wait()
+    // run tasks (ours or anyone's) until every task spawned here is done,
+    // then rethrow the first exception one of them threw
+    {
+        help_until_done();
+        if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+private:
+    friend class work_stealing_pool;
+
+    void help_until_done()
+    {
+        size_t i = pool.self();
+        while (pending.load(std::memory_order_acquire) > 0)
+            if (!pool.run_one(i)) std::this_thread::yield();
+    }
+
+    void finish(std::exception_ptr e)
+    {
+        if (e) {
+            std::lock_guard<std::mutex> lock{ m };
+            if (!error) error = e;
+        }
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    work_stealing_pool& pool;
+    std::atomic<size_t> pending{ 0 };   // spawned, not yet finished
+    std::mutex m;
+    std::exception_ptr error;           // first exception thrown by a task, guarded by m
+};
+
+inline bool work_stealing_pool::run_one(size_t i)
+{
+    task* t = nullptr;
+    bool found = i != npos && workers[i].dq.pop(t);
+    if (!found) found = injected.try_pop(t);
+    if (!found) {
+        // steal, starting after ourselves so thieves spread over the victims
+        size_t start = i == npos ? 0 : i + 1;
+        for (size_t k = 0; k < nworkers && !found; ++k) {
+            size_t v = (start + k) % nworkers;
+            if (v != i) found = workers[v].dq.steal(t);
+        }
+    }
+    if (!found) return false;
+
+    std::exception_ptr e;
+    try {
+        t->f();
+    }
+    catch (...) {
+        e = std::current_exception();
+    }
+    task_group* g = t->group;
+    delete t;
+    g->finish(e);
+    return true;
+}